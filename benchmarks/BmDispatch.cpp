@@ -1,20 +1,35 @@
 #include <benchmark/benchmark.h>
 #include <eventpp/eventqueue.h>
 
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <numeric>
 #include <random>
+#include <thread>
+#include <vector>
 
+#include "BmLoops.h"
+#include "eventHub/SpecialEventQueue/InplaceFunction.h"
+#include "eventHub/SpecialEventQueue/PriorityEventQueue.h"
+#include "eventHub/SpecialEventQueue/Queues/BoundedMpmcQueue.h"
 #include "eventHub/SpecialEventQueue/Queues/MoodycamelQueue.h"
+#include "eventHub/SpecialEventQueue/Queues/MpscQueue.h"
 #include "eventHub/SpecialEventQueue/Queues/NaiveQeue.h"
+#include "eventHub/SpecialEventQueue/Queues/SpscRingQueue.h"
 #include "eventHub/SpecialEventQueue/SpecialEventQueue.h"
+#include "eventHub/SpecialHub.h"
+#include "eventHub/ThreadPlacement.h"
 
 using namespace eventTree::eventHubs;
 using namespace eventTree::queues;
 
 enum class EventType { A, B, C };
+enum class DenseEventType : std::uint8_t { A, B, C };
 
 struct Event {
     EventType type;
@@ -30,6 +45,9 @@ using NaiveSpecialQueue =
 using ConcurrentSpecialQueue =
     SpecialEventQueue<EventType, HandlerType, MoodycamelQueue<Event>>;
 
+using DenseConcurrentSpecialQueue =
+    SpecialEventQueue<DenseEventType, HandlerType, MoodycamelQueue<Event>>;
+
 using EventppQueue = eventpp::EventQueue<EventType, void(const Event&)>;
 
 struct ResponseTimeStats {
@@ -65,7 +83,7 @@ static void BM_ResponseTime(benchmark::State& state) {
 
         // Add handlers
         for (int i = 0; i < 3; ++i) {
-            EventType type = static_cast<EventType>(i);
+            auto type = static_cast<typename QueueType::key_type>(i);
             queue.appendListener(type, [&stats](const Event& e) {
                 auto now = std::chrono::high_resolution_clock::now();
                 double response_time =
@@ -80,9 +98,11 @@ static void BM_ResponseTime(benchmark::State& state) {
         std::mt19937 gen(rd());
         std::uniform_int_distribution<> dis(0, 2);
         for (int i = 0; i < state.range(0); ++i) {
-            EventType type = static_cast<EventType>(dis(gen));
-            Event event{type, i, std::chrono::high_resolution_clock::now()};
-            queue.enqueue(type, event);
+            int index = dis(gen);
+            Event event{static_cast<EventType>(index), i,
+                        std::chrono::high_resolution_clock::now()};
+            queue.enqueue(static_cast<typename QueueType::key_type>(index),
+                          event);
         }
         state.ResumeTiming();
 
@@ -104,6 +124,8 @@ static void BM_ResponseTime(benchmark::State& state) {
 
 BENCHMARK_TEMPLATE(BM_ResponseTime, NaiveSpecialQueue)->Range(8, 8 << 10);
 BENCHMARK_TEMPLATE(BM_ResponseTime, ConcurrentSpecialQueue)->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(BM_ResponseTime, DenseConcurrentSpecialQueue)
+    ->Range(8, 8 << 10);
 
 static void BM_ResponseTime_Eventpp(benchmark::State& state) {
     for (auto _ : state) {
@@ -150,4 +172,538 @@ static void BM_ResponseTime_Eventpp(benchmark::State& state) {
 
 BENCHMARK(BM_ResponseTime_Eventpp)->Range(8, 8 << 10);
 
-BENCHMARK_MAIN();
\ No newline at end of file
+/**
+ * Many registered event types, only a few of them hot. Measures how much a
+ * backlog costs to drain when most round-robin positions have no work.
+ */
+template <typename Queue>
+static void BM_SparseDispatch(benchmark::State& state) {
+    const int eventTypeCount = static_cast<int>(state.range(0));
+    const int hotTypeCount = 4;
+    const int eventsPerHotType = 256;
+    const int totalEvents = hotTypeCount * eventsPerHotType;
+
+    std::int64_t processOneCalls = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto queue = std::make_unique<Queue>();
+        int processed = 0;
+        for (int type = 0; type < eventTypeCount; ++type) {
+            queue->appendListener(
+                type, [&processed](const Event&) { ++processed; });
+        }
+        // Hot types are spread over the whole range of registered types.
+        for (int i = 0; i < eventsPerHotType; ++i) {
+            for (int hot = 0; hot < hotTypeCount; ++hot) {
+                int type = hot * (eventTypeCount / hotTypeCount);
+                queue->enqueue(type, Event{EventType::A, i, {}});
+            }
+        }
+        state.ResumeTiming();
+
+        while (processed < totalEvents) {
+            queue->processOne();
+            ++processOneCalls;
+        }
+
+        state.PauseTiming();
+        queue.reset();
+        state.ResumeTiming();
+    }
+    state.counters["ProcessOne_Calls_Per_Event"] = benchmark::Counter(
+        static_cast<double>(processOneCalls) /
+        static_cast<double>(totalEvents * state.iterations()));
+    state.SetItemsProcessed(totalEvents * state.iterations());
+}
+
+using SparseNaiveSpecialQueue =
+    SpecialEventQueue<int, HandlerType, NaiveQueue<Event>>;
+using SparseConcurrentSpecialQueue =
+    SpecialEventQueue<int, HandlerType, MoodycamelQueue<Event>>;
+
+BENCHMARK_TEMPLATE(BM_SparseDispatch, SparseNaiveSpecialQueue)
+    ->RangeMultiplier(4)
+    ->Range(4, 4 << 10);
+BENCHMARK_TEMPLATE(BM_SparseDispatch, SparseConcurrentSpecialQueue)
+    ->RangeMultiplier(4)
+    ->Range(4, 4 << 10);
+
+/**
+ * Time from enqueue until the handler runs on a consumer that was parked in
+ * waitForEvents() because the queue was empty.
+ */
+template <typename Queue>
+static void BM_ParkedWakeup(benchmark::State& state) {
+    Queue queue;
+    std::atomic<bool> running{true};
+    std::atomic<std::int64_t> handledAt{0};
+
+    queue.appendListener(EventType::A, [&handledAt](const Event&) {
+        handledAt.store(std::chrono::high_resolution_clock::now()
+                            .time_since_epoch()
+                            .count());
+    });
+
+    std::thread consumer([&] {
+        while (running) {
+            if (!queue.processOne()) {
+                queue.waitForEvents([&running] { return !running; });
+            }
+        }
+    });
+
+    ResponseTimeStats stats;
+    for (auto _ : state) {
+        // Let the consumer run out of work and park.
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        handledAt.store(0);
+
+        auto enqueuedAt = std::chrono::high_resolution_clock::now();
+        queue.enqueue(EventType::A, Event{EventType::A, 0, enqueuedAt});
+        while (handledAt.load() == 0) {
+            std::this_thread::yield();
+        }
+
+        std::chrono::duration<double> latency(
+            std::chrono::high_resolution_clock::duration(handledAt.load()) -
+            enqueuedAt.time_since_epoch());
+        state.SetIterationTime(latency.count());
+        stats.update(latency.count() * 1e6);
+    }
+
+    running = false;
+    queue.notifyAll();
+    consumer.join();
+
+    state.counters["Avg_Wakeup_us"] = benchmark::Counter(stats.avg());
+    state.counters["Max_Wakeup_us"] = benchmark::Counter(stats.max);
+}
+
+BENCHMARK_TEMPLATE(BM_ParkedWakeup, NaiveSpecialQueue)
+    ->UseManualTime()
+    ->Iterations(2000);
+BENCHMARK_TEMPLATE(BM_ParkedWakeup, ConcurrentSpecialQueue)
+    ->UseManualTime()
+    ->Iterations(2000);
+
+/**
+ * Per-type handler state, large enough that it only stays hot in the caches
+ * of a core that keeps handling the same type.
+ */
+struct alignas(64) TypeState {
+    std::array<std::atomic<std::uint64_t>, 4096> cells{};
+    alignas(64) std::atomic<std::int64_t> handled{0};
+};
+
+/**
+ * Three event types handled by three consumer threads. With `Pinned` every
+ * type has its own queue and a consumer pinned to its own CPU; otherwise all
+ * consumers share one queue and take turns on every type.
+ */
+template <bool Pinned>
+static void BM_PlacementDispatch(benchmark::State& state) {
+    constexpr int typeCount = 3;
+    const int eventsPerType = static_cast<int>(state.range(0));
+    const auto cpuCount = std::max(1U, std::thread::hardware_concurrency());
+
+    std::vector<std::unique_ptr<DenseConcurrentSpecialQueue>> queues;
+    for (int i = 0; i < (Pinned ? typeCount : 1); ++i) {
+        queues.push_back(std::make_unique<DenseConcurrentSpecialQueue>());
+    }
+    auto queueOf = [&](int type) -> DenseConcurrentSpecialQueue& {
+        return *queues[Pinned ? type : 0];
+    };
+
+    std::array<TypeState, typeCount> states;
+    for (int type = 0; type < typeCount; ++type) {
+        auto& typeState = states[type];
+        queueOf(type).appendListener(
+            static_cast<DenseEventType>(type), [&typeState](const Event& e) {
+                auto index = static_cast<std::size_t>(e.data) * 7919 %
+                             typeState.cells.size();
+                typeState.cells[index].fetch_add(1, std::memory_order_relaxed);
+                typeState.handled.fetch_add(1, std::memory_order_release);
+            });
+    }
+
+    std::atomic<bool> running{true};
+    std::vector<std::thread> consumers;
+    for (int i = 0; i < typeCount; ++i) {
+        consumers.emplace_back([&, i] {
+            auto& queue = queueOf(i);
+            if constexpr (Pinned) {
+                applyToCurrentThread(ThreadPlacement{i % cpuCount});
+            }
+            DispatchCursor cursor{static_cast<std::size_t>(i)};
+            while (running) {
+                if (queue.processBatch(256, cursor) == 0) {
+                    queue.waitForEvents([&running] { return !running; });
+                }
+            }
+        });
+    }
+
+    std::int64_t target = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < eventsPerType; ++i) {
+            for (int type = 0; type < typeCount; ++type) {
+                queueOf(type).enqueue(static_cast<DenseEventType>(type),
+                                      Event{EventType::A, i, {}});
+            }
+        }
+        target += eventsPerType;
+        for (auto& typeState : states) {
+            while (typeState.handled.load(std::memory_order_acquire) <
+                   target) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    running = false;
+    for (auto& queue : queues) {
+        queue->notifyAll();
+    }
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+    state.SetItemsProcessed(state.iterations() * eventsPerType * typeCount);
+}
+
+BENCHMARK_TEMPLATE(BM_PlacementDispatch, false)
+    ->Name("BM_PlacementDispatch/Shared")
+    ->RangeMultiplier(8)
+    ->Range(64, 4 << 10)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_PlacementDispatch, true)
+    ->Name("BM_PlacementDispatch/Pinned")
+    ->RangeMultiplier(8)
+    ->Range(64, 4 << 10)
+    ->UseRealTime();
+
+/**
+ * The same workload through SpecialHub. With `Pinned` every type is routed to
+ * a PinnedWorker on its own CPU; otherwise a pool of three workers shares the
+ * hub's queue.
+ */
+template <bool Pinned>
+static void BM_HubPlacement(benchmark::State& state) {
+    constexpr int typeCount = 3;
+    const int eventsPerType = static_cast<int>(state.range(0));
+    const auto cpuCount = std::max(1U, std::thread::hardware_concurrency());
+    const std::array<eventTree::events::EventType, typeCount> types{
+        eventTree::events::EventType::Blessing,
+        eventTree::events::EventType::Joy, eventTree::events::EventType::Chaos};
+
+    DispatchOptions options;
+    std::vector<PinnedWorker> pinned;
+    if constexpr (Pinned) {
+        for (int type = 0; type < typeCount; ++type) {
+            pinned.push_back(PinnedWorker{
+                {types[type]},
+                ThreadPlacement{static_cast<unsigned>(type) % cpuCount}});
+        }
+    } else {
+        options.workers = typeCount;
+    }
+    SpecialHub hub(options, pinned);
+
+    std::array<TypeState, typeCount> states;
+    std::array<eventTree::events::EventPtr, typeCount> events;
+    for (int type = 0; type < typeCount; ++type) {
+        auto& typeState = states[type];
+        events[type] = std::make_shared<eventTree::events::Event>(types[type]);
+        hub.registerHandler(
+            types[type], [&typeState](const eventTree::events::EventPtr&) {
+                auto handled =
+                    typeState.handled.load(std::memory_order_relaxed);
+                auto index = static_cast<std::size_t>(handled) * 7919 %
+                             typeState.cells.size();
+                typeState.cells[index].fetch_add(1, std::memory_order_relaxed);
+                typeState.handled.fetch_add(1, std::memory_order_release);
+            });
+    }
+
+    std::int64_t target = 0;
+    for (auto _ : state) {
+        for (int i = 0; i < eventsPerType; ++i) {
+            for (int type = 0; type < typeCount; ++type) {
+                hub.emitEvent(types[type], events[type]);
+            }
+        }
+        target += eventsPerType;
+        for (auto& typeState : states) {
+            while (typeState.handled.load(std::memory_order_acquire) <
+                   target) {
+                std::this_thread::yield();
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * eventsPerType * typeCount);
+}
+
+BENCHMARK_TEMPLATE(BM_HubPlacement, false)
+    ->Name("BM_HubPlacement/Shared")
+    ->RangeMultiplier(8)
+    ->Range(64, 4 << 10)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_HubPlacement, true)
+    ->Name("BM_HubPlacement/Pinned")
+    ->RangeMultiplier(8)
+    ->Range(64, 4 << 10)
+    ->UseRealTime();
+
+/**
+ * Latency of an urgent event while a flood over 64 event types keeps the
+ * consumer saturated. With `Prioritized` the urgent event takes lane 0 and
+ * the flood lane 1; otherwise both share lane 1 and the urgent type has to
+ * wait for its round-robin turn.
+ */
+template <bool Prioritized>
+static void BM_PriorityLatency(benchmark::State& state) {
+    constexpr int floodTypeCount = 64;
+    constexpr int urgentType = floodTypeCount;
+    PriorityEventQueue<SparseConcurrentSpecialQueue, 2> queue;
+    std::atomic<bool> running{true};
+    std::atomic<std::int64_t> handledAt{0};
+
+    // Every flood event enqueues itself again, so the backlog never drains.
+    for (int type = 0; type < floodTypeCount; ++type) {
+        queue.appendListener(type, [&queue, type](const Event& e) {
+            auto end =
+                std::chrono::steady_clock::now() + std::chrono::microseconds(1);
+            while (std::chrono::steady_clock::now() < end) {
+            }
+            queue.enqueue(1, type, e);
+        });
+        for (int i = 0; i < 4; ++i) {
+            queue.enqueue(1, type, Event{EventType::A, i, {}});
+        }
+    }
+    queue.appendListener(urgentType, [&handledAt](const Event&) {
+        handledAt.store(std::chrono::high_resolution_clock::now()
+                            .time_since_epoch()
+                            .count());
+    });
+
+    std::thread consumer([&] {
+        while (running) {
+            if (!queue.processOne()) {
+                queue.waitForEvents([&running] { return !running; });
+            }
+        }
+    });
+
+    ResponseTimeStats stats;
+    for (auto _ : state) {
+        handledAt.store(0);
+        auto enqueuedAt = std::chrono::high_resolution_clock::now();
+        queue.enqueue(Prioritized ? 0 : 1, urgentType,
+                      Event{EventType::A, 0, enqueuedAt});
+        while (handledAt.load() == 0) {
+            std::this_thread::yield();
+        }
+
+        std::chrono::duration<double> latency(
+            std::chrono::high_resolution_clock::duration(handledAt.load()) -
+            enqueuedAt.time_since_epoch());
+        state.SetIterationTime(latency.count());
+        stats.update(latency.count() * 1e6);
+    }
+
+    running = false;
+    queue.notifyAll();
+    consumer.join();
+
+    state.counters["Avg_Urgent_Latency_us"] = benchmark::Counter(stats.avg());
+    state.counters["Max_Urgent_Latency_us"] = benchmark::Counter(stats.max);
+}
+
+BENCHMARK_TEMPLATE(BM_PriorityLatency, false)
+    ->Name("BM_PriorityLatency/SharedLane")
+    ->UseManualTime()
+    ->Iterations(2000);
+BENCHMARK_TEMPLATE(BM_PriorityLatency, true)
+    ->Name("BM_PriorityLatency/HighLane")
+    ->UseManualTime()
+    ->Iterations(2000);
+
+/**
+ * Producers that emit bursts, drained by a consumer that takes up to
+ * state.range(0) events of a type per visit. Bulk producers hand each burst
+ * to the queue with a single enqueueBulk().
+ */
+template <typename Queue, bool Bulk>
+static void BM_BulkDispatch(benchmark::State& state) {
+    const auto burst = static_cast<std::size_t>(state.range(0));
+    const int burstsPerType = 64;
+    const int burstLength = 16;
+    const std::array<EventType, 3> types{EventType::A, EventType::B,
+                                         EventType::C};
+    const auto totalEvents =
+        static_cast<std::int64_t>(types.size()) * burstsPerType * burstLength;
+
+    std::vector<Event> events(burstLength, Event{EventType::A, 0, {}});
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto queue = std::make_unique<Queue>(SchedulingOptions{.burst = burst});
+        std::int64_t processed = 0;
+        for (auto type : types) {
+            queue->appendListener(
+                type, [&processed](const Event&) { ++processed; });
+        }
+        state.ResumeTiming();
+
+        for (int i = 0; i < burstsPerType; ++i) {
+            for (auto type : types) {
+                if constexpr (Bulk) {
+                    queue->enqueueBulk(type, events.begin(), events.end());
+                } else {
+                    for (const auto& event : events) {
+                        queue->enqueue(type, event);
+                    }
+                }
+            }
+        }
+        while (processed < totalEvents) {
+            queue->processBatch(1024);  // NOLINT
+        }
+
+        state.PauseTiming();
+        queue.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(totalEvents * state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_BulkDispatch, NaiveSpecialQueue, false)
+    ->RangeMultiplier(4)
+    ->Range(1, 16);
+BENCHMARK_TEMPLATE(BM_BulkDispatch, NaiveSpecialQueue, true)
+    ->RangeMultiplier(4)
+    ->Range(1, 16);
+BENCHMARK_TEMPLATE(BM_BulkDispatch, ConcurrentSpecialQueue, false)
+    ->RangeMultiplier(4)
+    ->Range(1, 16);
+BENCHMARK_TEMPLATE(BM_BulkDispatch, ConcurrentSpecialQueue, true)
+    ->RangeMultiplier(4)
+    ->Range(1, 16);
+
+/**
+ * One producer thread per event type feeding a single dispatcher, the
+ * topology SpscRingQueue is made for. Measures end-to-end throughput.
+ */
+template <typename Queue>
+static void BM_SingleProducerHandoff(benchmark::State& state) {
+    const int eventsPerType = 4096;
+    const std::array<EventType, 3> types{EventType::A, EventType::B,
+                                         EventType::C};
+    runHandoff<Queue>(
+        state, static_cast<int>(types.size()),
+        static_cast<std::int64_t>(types.size()) * eventsPerType,
+        [&types](Queue& queue, std::int64_t& processed) {
+            for (auto type : types) {
+                queue.appendListener(
+                    type, [&processed](const Event&) { ++processed; });
+            }
+        },
+        [&types, eventsPerType](Queue& queue, int producer) {
+            auto type = types[producer];
+            for (int i = 0; i < eventsPerType; ++i) {
+                queue.enqueue(type, Event{type, i, {}});
+            }
+        });
+}
+
+using SpscSpecialQueue =
+    SpecialEventQueue<EventType, HandlerType, SpscRingQueue<Event>>;
+
+BENCHMARK_TEMPLATE(BM_SingleProducerHandoff, NaiveSpecialQueue)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SingleProducerHandoff, ConcurrentSpecialQueue)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_SingleProducerHandoff, SpscSpecialQueue)
+    ->UseRealTime();
+
+/**
+ * Several producer threads feeding one event type to a single dispatcher, the
+ * topology MpscQueue is made for. The argument is the number of producers.
+ */
+template <typename Queue>
+static void BM_ManyProducersOneConsumer(benchmark::State& state) {
+    const auto producerCount = static_cast<int>(state.range(0));
+    const int eventsPerProducer = 8192;
+    runHandoff<Queue>(
+        state, producerCount,
+        static_cast<std::int64_t>(producerCount) * eventsPerProducer,
+        [](Queue& queue, std::int64_t& processed) {
+            queue.appendListener(EventType::A,
+                                 [&processed](const Event&) { ++processed; });
+        },
+        [eventsPerProducer](Queue& queue, int /*producer*/) {
+            for (int i = 0; i < eventsPerProducer; ++i) {
+                queue.enqueue(EventType::A, Event{EventType::A, i, {}});
+            }
+        });
+}
+
+using BoundedSpecialQueue =
+    SpecialEventQueue<EventType, HandlerType, BoundedMpmcQueue<Event>>;
+
+using MpscSpecialQueue =
+    SpecialEventQueue<EventType, HandlerType, MpscQueue<Event>>;
+
+BENCHMARK_TEMPLATE(BM_ManyProducersOneConsumer, NaiveSpecialQueue)
+    ->RangeMultiplier(2)
+    ->Range(1, 4)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ManyProducersOneConsumer, ConcurrentSpecialQueue)
+    ->RangeMultiplier(2)
+    ->Range(1, 4)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ManyProducersOneConsumer, BoundedSpecialQueue)
+    ->RangeMultiplier(2)
+    ->Range(1, 4)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ManyProducersOneConsumer, MpscSpecialQueue)
+    ->RangeMultiplier(2)
+    ->Range(1, 4)
+    ->UseRealTime();
+
+/**
+ * The handlers of an event type called for every event, as std::function and
+ * as InplaceFunction. Each handler captures more state than std::function
+ * keeps inline, so its std::function targets live on the heap. Events are
+ * queued untimed and dispatched in one timed processBatch(). The argument is
+ * the number of handlers per type.
+ */
+template <typename Handler>
+static void BM_HandlerCall(benchmark::State& state) {
+    const auto handlerCount = static_cast<int>(state.range(0));
+    const int eventCount = 4096;
+
+    SpecialEventQueue<EventType, Handler, NaiveQueue<Event>> queue;
+    std::int64_t sum = 0;
+    for (int i = 0; i < handlerCount; ++i) {
+        queue.appendListener(
+            EventType::A, [&sum, weights = std::array<int, 4>{i, i, i, i}](
+                              const Event& event) {
+                sum += event.data * weights[event.data & 3];
+            });
+    }
+
+    runFanOut(state, queue, handlerCount, eventCount,
+              [](auto& target, int i) {
+                  target.enqueue(EventType::A, Event{EventType::A, i, {}});
+              });
+    benchmark::DoNotOptimize(sum);
+}
+
+BENCHMARK_TEMPLATE(BM_HandlerCall, HandlerType)
+    ->RangeMultiplier(4)
+    ->Range(1, 16);
+BENCHMARK_TEMPLATE(BM_HandlerCall, InplaceFunction<void(const Event&)>)
+    ->RangeMultiplier(4)
+    ->Range(1, 16);
+
+BENCHMARK_MAIN();
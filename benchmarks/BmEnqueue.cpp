@@ -1,17 +1,24 @@
 #include <benchmark/benchmark.h>
 #include <eventpp/eventqueue.h>
 
+#include <array>
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <random>
 
+#include "eventHub/SpecialEventQueue/MappedEventQueue.h"
+#include "eventHub/SpecialEventQueue/Queues/BoundedMpmcQueue.h"
 #include "eventHub/SpecialEventQueue/Queues/MoodycamelQueue.h"
 #include "eventHub/SpecialEventQueue/Queues/NaiveQeue.h"
+#include "eventHub/SpecialEventQueue/Queues/SpscRingQueue.h"
 #include "eventHub/SpecialEventQueue/SpecialEventQueue.h"
 
 using namespace eventTree::eventHubs;
 using namespace eventTree::queues;
 
 enum class EventType { A, B, C };
+enum class DenseEventType : std::uint8_t { A, B, C };
 
 struct Event {
     EventType type;
@@ -26,6 +33,21 @@ using NaiveSpecialQueue =
 using ConcurrentSpecialQueue =
     SpecialEventQueue<EventType, HandlerType, MoodycamelQueue<Event>>;
 
+using DenseConcurrentSpecialQueue =
+    SpecialEventQueue<DenseEventType, HandlerType, MoodycamelQueue<Event>>;
+
+using SpscSpecialQueue =
+    SpecialEventQueue<EventType, HandlerType, SpscRingQueue<Event>>;
+
+using BoundedSpecialQueue =
+    SpecialEventQueue<EventType, HandlerType, BoundedMpmcQueue<Event>>;
+
+/** Bounded storage for A, a ring for B and the lock-free default for C. */
+using MappedSpecialQueue =
+    MappedEventQueue<EventType, HandlerType, MoodycamelQueue<Event>,
+                     QueueFor<EventType::A, BoundedMpmcQueue<Event>>,
+                     QueueFor<EventType::B, SpscRingQueue<Event>>>;
+
 using EventppQueue = eventpp::EventQueue<EventType, void(const Event&)>;
 
 template <typename QueueType>
@@ -36,15 +58,105 @@ static void BM_EmitEvents_Queue(benchmark::State& state) {
     std::uniform_int_distribution<> dis(0, 2);
 
     for (auto _ : state) {
-        EventType type = static_cast<EventType>(dis(gen));
-        Event event{type, 0};
-        queue.enqueue(type, event);
+        int index = dis(gen);
+        Event event{static_cast<EventType>(index), 0};
+        queue.enqueue(static_cast<typename QueueType::key_type>(index), event);
     }
 }
 
 BENCHMARK_TEMPLATE(BM_EmitEvents_Queue, NaiveSpecialQueue)->Range(8, 8 << 10);
 BENCHMARK_TEMPLATE(BM_EmitEvents_Queue, ConcurrentSpecialQueue)
     ->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Queue, DenseConcurrentSpecialQueue)
+    ->Range(8, 8 << 10);
+
+/**
+ * Same as BM_EmitEvents_Queue, but the producer opens a channel per type up
+ * front and enqueues through it, without looking the type up per event.
+ */
+template <typename QueueType>
+static void BM_EmitEvents_Channel(benchmark::State& state) {
+    QueueType queue;
+    std::array channels{
+        queue.channel(static_cast<typename QueueType::key_type>(0)),
+        queue.channel(static_cast<typename QueueType::key_type>(1)),
+        queue.channel(static_cast<typename QueueType::key_type>(2))};
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 2);
+
+    for (auto _ : state) {
+        int index = dis(gen);
+        Event event{static_cast<EventType>(index), 0};
+        channels[index].push(event);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_EmitEvents_Channel, NaiveSpecialQueue)
+    ->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Channel, ConcurrentSpecialQueue)
+    ->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Channel, DenseConcurrentSpecialQueue)
+    ->Range(8, 8 << 10);
+
+/**
+ * Same as BM_EmitEvents_Queue, but the producer enqueues through its own
+ * token, which lock-free queues use to skip the per-call producer lookup.
+ */
+template <typename QueueType>
+static void BM_EmitEvents_Token(benchmark::State& state) {
+    QueueType queue;
+    auto token = queue.producerToken();
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 2);
+
+    for (auto _ : state) {
+        int index = dis(gen);
+        Event event{static_cast<EventType>(index), 0};
+        queue.enqueue(token,
+                      static_cast<typename QueueType::key_type>(index), event);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_EmitEvents_Token, NaiveSpecialQueue)->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Token, ConcurrentSpecialQueue)
+    ->Range(8, 8 << 10);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Token, DenseConcurrentSpecialQueue)
+    ->Range(8, 8 << 10);
+
+/**
+ * Enqueue cost with a backlog that never outgrows a bounded queue: the queue
+ * is drained, outside the timed region, every time it holds drainEvery
+ * events.
+ */
+template <typename QueueType>
+static void BM_EmitEvents_Drained(benchmark::State& state) {
+    const std::size_t drainEvery = 512;
+    QueueType queue;
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::uniform_int_distribution<> dis(0, 2);
+
+    std::size_t backlog = 0;
+    for (auto _ : state) {
+        int index = dis(gen);
+        Event event{static_cast<EventType>(index), 0};
+        queue.enqueue(static_cast<typename QueueType::key_type>(index), event);
+        if (++backlog == drainEvery) {
+            state.PauseTiming();
+            queue.processBatch(drainEvery);
+            backlog = 0;
+            state.ResumeTiming();
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_EmitEvents_Drained, NaiveSpecialQueue);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Drained, ConcurrentSpecialQueue);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Drained, SpscSpecialQueue);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Drained, BoundedSpecialQueue);
+BENCHMARK_TEMPLATE(BM_EmitEvents_Drained, MappedSpecialQueue);
 
 static void BM_EmitEvents_Eventpp(benchmark::State& state) {
     EventppQueue queue;
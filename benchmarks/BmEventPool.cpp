@@ -0,0 +1,199 @@
+/**
+ * @file BmEventPool.cpp
+ * @brief Benchmark of event allocation with std::make_shared against the
+ * recycling EventPool.
+ *
+ * @details Four scenarios, the first two run with both factories:
+ * - BM_AllocateAndRelease: every benchmark thread creates an event and
+ *   drops it right away. With many threads this measures how much the
+ *   allocator makes them contend.
+ * - BM_EmitAcrossThreads: producer threads create events and enqueue them;
+ *   a single consumer handles them and drops the last reference, so every
+ *   event is freed on a different thread than it was allocated on, as in
+ *   the hub. The argument is the number of producers.
+ * - BM_EmitByValue: the same flow for a ValueChannel's queue, which stores
+ *   Flood events by value, against the EventPtr queue whose handler has to
+ *   downcast every event.
+ * - BM_HandlerFanOut: one event type with several handlers, taking the
+ *   EventPtr by value as registerHandler() used to, or by reference as
+ *   EventHandler does. The argument is the number of handlers.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "BmLoops.h"
+#include "eventHub/IEventHub.h"
+#include "eventHub/SpecialEventQueue/Queues/MoodycamelQueue.h"
+#include "eventHub/SpecialEventQueue/SpecialEventQueue.h"
+#include "events/Event.h"
+#include "events/EventPool.h"
+#include "events/Flood.h"
+
+using namespace eventTree;
+using namespace eventTree::eventHubs;
+using namespace eventTree::queues;
+
+/** Allocates every event on its own, as the producers used to. */
+struct MakeShared {
+    static events::EventPtr make() {
+        return std::make_shared<events::Flood>("Iran");
+    }
+};
+
+/** Takes every event from the recycling pool. */
+struct MakePooled {
+    static events::EventPtr make() {
+        return events::makePooled<events::Flood>("Iran");
+    }
+};
+
+using EventQueue = SpecialEventQueue<events::EventType, EventHandler,
+                                    MoodycamelQueue<events::EventPtr>>;
+
+template <typename Factory>
+static void BM_AllocateAndRelease(benchmark::State& state) {
+    for (auto _ : state) {
+        auto event = Factory::make();
+        benchmark::DoNotOptimize(event.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_AllocateAndRelease, MakeShared)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_AllocateAndRelease, MakePooled)
+    ->ThreadRange(1, 16)
+    ->UseRealTime();
+
+template <typename Factory>
+static void BM_EmitAcrossThreads(benchmark::State& state) {
+    const auto producerCount = static_cast<int>(state.range(0));
+    const int eventsPerProducer = 16384;
+    runHandoff<EventQueue>(
+        state, producerCount,
+        static_cast<std::int64_t>(producerCount) * eventsPerProducer,
+        [](EventQueue& queue, std::int64_t& processed) {
+            queue.appendListener(
+                events::EventType::Flood,
+                [&processed](const events::EventPtr&) { ++processed; });
+        },
+        [eventsPerProducer](EventQueue& queue, int /*producer*/) {
+            auto channel = queue.channel(events::EventType::Flood);
+            for (int i = 0; i < eventsPerProducer; ++i) {
+                channel.push(Factory::make());
+            }
+        });
+}
+
+BENCHMARK_TEMPLATE(BM_EmitAcrossThreads, MakeShared)
+    ->Arg(8)
+    ->Arg(16)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_EmitAcrossThreads, MakePooled)
+    ->Arg(8)
+    ->Arg(16)
+    ->UseRealTime();
+
+/** Emits shared pointers, which handlers downcast to the event class. */
+struct EmitPointer {
+    using Queue = EventQueue;
+
+    static void listen(Queue& queue, std::int64_t& processed) {
+        queue.appendListener(events::EventType::Flood,
+                             [&processed](const events::EventPtr& event) {
+                                 auto flood =
+                                     std::static_pointer_cast<events::Flood>(
+                                         event);
+                                 benchmark::DoNotOptimize(flood.get());
+                                 ++processed;
+                             });
+    }
+
+    static void emit(Queue::Channel& channel) {
+        channel.push(events::makePooled<events::Flood>("Iran"));
+    }
+};
+
+/** Emits Flood events by value, as a ValueChannel does. */
+struct EmitValue {
+    using Queue =
+        SpecialEventQueue<events::EventType,
+                          std::function<void(const events::Flood&)>,
+                          MoodycamelQueue<events::Flood>>;
+
+    static void listen(Queue& queue, std::int64_t& processed) {
+        queue.appendListener(events::EventType::Flood,
+                             [&processed](const events::Flood& event) {
+                                 benchmark::DoNotOptimize(&event);
+                                 ++processed;
+                             });
+    }
+
+    static void emit(Queue::Channel& channel) {
+        channel.push(events::Flood("Iran"));
+    }
+};
+
+template <typename Emitter>
+static void BM_EmitByValue(benchmark::State& state) {
+    using Queue = typename Emitter::Queue;
+    const auto producerCount = static_cast<int>(state.range(0));
+    const int eventsPerProducer = 16384;
+    runHandoff<Queue>(
+        state, producerCount,
+        static_cast<std::int64_t>(producerCount) * eventsPerProducer,
+        &Emitter::listen,
+        [eventsPerProducer](Queue& queue, int /*producer*/) {
+            auto channel = queue.channel(events::EventType::Flood);
+            for (int i = 0; i < eventsPerProducer; ++i) {
+                Emitter::emit(channel);
+            }
+        });
+}
+
+BENCHMARK_TEMPLATE(BM_EmitByValue, EmitPointer)
+    ->Arg(1)
+    ->Arg(8)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_EmitByValue, EmitValue)
+    ->Arg(1)
+    ->Arg(8)
+    ->UseRealTime();
+
+template <typename Handler>
+static void BM_HandlerFanOut(benchmark::State& state) {
+    const auto handlerCount = static_cast<int>(state.range(0));
+    const int eventCount = 4096;
+
+    SpecialEventQueue<events::EventType, Handler,
+                      MoodycamelQueue<events::EventPtr>>
+        queue;
+    std::int64_t handled = 0;
+    for (int i = 0; i < handlerCount; ++i) {
+        queue.appendListener(
+            events::EventType::Flood,
+            [&handled](const events::EventPtr& event) {
+                benchmark::DoNotOptimize(event.get());
+                ++handled;
+            });
+    }
+
+    runFanOut(state, queue, handlerCount, eventCount,
+              [](auto& target, int /*index*/) {
+                  target.enqueue(events::EventType::Flood,
+                                 events::makePooled<events::Flood>("Iran"));
+              });
+    benchmark::DoNotOptimize(handled);
+}
+
+BENCHMARK_TEMPLATE(BM_HandlerFanOut, std::function<void(events::EventPtr)>)
+    ->RangeMultiplier(4)
+    ->Range(1, 16);
+BENCHMARK_TEMPLATE(BM_HandlerFanOut, EventHandler)
+    ->RangeMultiplier(4)
+    ->Range(1, 16);
@@ -38,13 +38,25 @@
  * - 1 indicates perfect fairness (all event types processed equally)
  * - 1/n indicates maximum unfairness (only one event type processed)
  *
+ * @section weighted_fairness Weighted Fairness
+ *
+ * BM_WeightedFairness gives the types weights of 3:2:1 and handlers that
+ * cost 1, 2 and 4 microseconds, then measures which share of the events and
+ * of the handler time each type received. Weighted_Error is the largest
+ * distance between a measured share and its target: the event share for
+ * Fairness::Deficit, the time share for Fairness::DeficitByTime, and the
+ * event share for plain round robin, which ignores the weights.
+ *
  */
 
 #include <benchmark/benchmark.h>
 #include <eventpp/eventqueue.h>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <random>
 #include <vector>
 
@@ -189,3 +201,76 @@ static void BM_Fairness_Eventpp(benchmark::State& state) {
 }
 
 BENCHMARK(BM_Fairness_Eventpp);
+
+template <Fairness Mode>
+static void BM_WeightedFairness(benchmark::State& state) {
+    constexpr std::array<std::uint32_t, 3> weights = {3, 2, 1};
+    constexpr std::array<int, 3> costMicroseconds = {1, 2, 4};
+    constexpr int eventsPerType = 600;
+    constexpr int processedEvents = 600;
+
+    std::array<double, 3> eventShare{};
+    std::array<double, 3> timeShare{};
+    for (auto _ : state) {
+        state.PauseTiming();
+        ConcurrentSpecialQueue queue(SchedulingOptions{.fairness = Mode});
+        std::array<int, 3> processedCounts = {0, 0, 0};
+        std::array<std::chrono::nanoseconds, 3> handlerTime{};
+
+        for (int i = 0; i < 3; ++i) {
+            EventType type = static_cast<EventType>(i);
+            queue.setWeight(type, weights[i]);
+            queue.appendListener(type, [&, i](const Event&) {
+                auto start = std::chrono::steady_clock::now();
+                auto end =
+                    start + std::chrono::microseconds(costMicroseconds[i]);
+                while (std::chrono::steady_clock::now() < end) {
+                }
+                handlerTime[i] += std::chrono::steady_clock::now() - start;
+                processedCounts[i]++;
+            });
+        }
+        for (int i = 0; i < eventsPerType; ++i) {
+            for (int type = 0; type < 3; ++type) {
+                queue.enqueue(static_cast<EventType>(type),
+                              Event{static_cast<EventType>(type), i});
+            }
+        }
+        state.ResumeTiming();
+
+        queue.processBatch(processedEvents);
+
+        state.PauseTiming();
+        double totalTime = 0;
+        for (auto time : handlerTime) {
+            totalTime += static_cast<double>(time.count());
+        }
+        for (int i = 0; i < 3; ++i) {
+            eventShare[i] = static_cast<double>(processedCounts[i]) /
+                            static_cast<double>(processedEvents);
+            timeShare[i] = static_cast<double>(handlerTime[i].count()) /
+                           totalTime;
+        }
+        state.ResumeTiming();
+    }
+
+    const auto& measured =
+        Mode == Fairness::DeficitByTime ? timeShare : eventShare;
+    double weightSum = 0;
+    for (auto weight : weights) {
+        weightSum += weight;
+    }
+    double error = 0;
+    for (int i = 0; i < 3; ++i) {
+        error = std::max(error, std::abs(measured[i] - weights[i] / weightSum));
+    }
+    state.counters["Weighted_Error"] = benchmark::Counter(error);
+    state.counters["Event_Share_A"] = benchmark::Counter(eventShare[0]);
+    state.counters["Event_Share_C"] = benchmark::Counter(eventShare[2]);
+    state.counters["Time_Share_A"] = benchmark::Counter(timeShare[0]);
+    state.counters["Time_Share_C"] = benchmark::Counter(timeShare[2]);
+}
+
+BENCHMARK_TEMPLATE(BM_WeightedFairness, Fairness::RoundRobin);
+BENCHMARK_TEMPLATE(BM_WeightedFairness, Fairness::Deficit);
+BENCHMARK_TEMPLATE(BM_WeightedFairness, Fairness::DeficitByTime);
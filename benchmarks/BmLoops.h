@@ -0,0 +1,88 @@
+/**
+ * @file BmLoops.h
+ * @brief Benchmark loops shared by the dispatch and event pool benchmarks.
+ */
+
+#ifndef BM_LOOPS_H
+#define BM_LOOPS_H
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/**
+ * Producer threads fill a fresh queue while the benchmark thread dispatches
+ * it, until every event was handled. Setting up and tearing down the queue is
+ * not timed.
+ *
+ * @tparam Queue The queue, default constructible.
+ * @param state The benchmark state.
+ * @param producerCount The number of producer threads.
+ * @param totalEvents The number of events the producers emit together.
+ * @param listen Called as listen(queue, processed) to register handlers that
+ * increment `processed` once per event.
+ * @param produce Called as produce(queue, index) on each producer thread.
+ */
+template <typename Queue, typename Listen, typename Produce>
+void runHandoff(benchmark::State& state, int producerCount,
+                std::int64_t totalEvents, Listen&& listen, Produce&& produce) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto queue = std::make_unique<Queue>();
+        std::int64_t processed = 0;
+        std::invoke(listen, *queue, processed);
+        state.ResumeTiming();
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < producerCount; ++p) {
+            producers.emplace_back(
+                [&queue, &produce, p] { std::invoke(produce, *queue, p); });
+        }
+        while (processed < totalEvents) {
+            if (queue->processBatch(256) == 0) {  // NOLINT
+                std::this_thread::yield();
+            }
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+
+        state.PauseTiming();
+        queue.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(totalEvents * state.iterations());
+}
+
+/**
+ * Fills a queue with a batch of events and times how long its handlers take
+ * to dispatch it on the benchmark thread. Filling the queue is not timed.
+ *
+ * @tparam Queue The queue, with its handlers registered.
+ * @param state The benchmark state.
+ * @param queue The queue.
+ * @param handlerCount The number of handlers every event is passed to.
+ * @param eventCount The number of events per batch.
+ * @param enqueue Called as enqueue(queue, index) to add one event.
+ */
+template <typename Queue, typename Enqueue>
+void runFanOut(benchmark::State& state, Queue& queue, int handlerCount,
+               int eventCount, Enqueue&& enqueue) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int i = 0; i < eventCount; ++i) {
+            std::invoke(enqueue, queue, i);
+        }
+        state.ResumeTiming();
+
+        queue.processBatch(eventCount);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(eventCount) *
+                            handlerCount * state.iterations());
+}
+
+#endif  // BM_LOOPS_H
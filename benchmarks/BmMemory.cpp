@@ -0,0 +1,118 @@
+/**
+ * @file BmMemory.cpp
+ * @brief Benchmark for the memory queue backends keep after a burst.
+ *
+ * @details Each iteration enqueues a burst of events of one type, drains it,
+ * then runs a steady trickle of a few events at a time. The resident set
+ * size of the process is sampled at each stage and reported as counters:
+ * - Rss_Before: before the burst.
+ * - Rss_Peak: with the whole burst queued.
+ * - Rss_Drained: right after the burst has been processed.
+ * - Rss_Steady: after the steady trickle.
+ * - Rss_Kept: Rss_Steady minus Rss_Before, which does not depend on what
+ *   earlier benchmarks in the process left behind.
+ *
+ * Queues that keep their grown storage report a steady RSS close to the
+ * peak. Memory freed through malloc may stay in the allocator, so
+ * SegmentedQueue unmaps drained segments beyond its pool itself and
+ * returns close to Rss_Before.
+ *
+ * RSS is read from /proc/self/statm and reads as 0 where that is missing.
+ */
+
+#include <benchmark/benchmark.h>
+#include <unistd.h>
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+
+#include "eventHub/SpecialEventQueue/Queues/MoodycamelQueue.h"
+#include "eventHub/SpecialEventQueue/Queues/NaiveQeue.h"
+#include "eventHub/SpecialEventQueue/Queues/SegmentedQueue.h"
+#include "eventHub/SpecialEventQueue/SpecialEventQueue.h"
+
+using namespace eventTree::eventHubs;
+using namespace eventTree::queues;
+
+enum class EventType { A, B, C };
+
+/** A Flood-sized event, so a burst weighs what it does in the hub. */
+struct Event {
+    EventType type;
+    std::array<std::int64_t, 8> payload;  // NOLINT
+};
+
+using HandlerType = std::function<void(const Event&)>;
+
+using NaiveSpecialQueue =
+    SpecialEventQueue<EventType, HandlerType, NaiveQueue<Event>>;
+
+using ConcurrentSpecialQueue =
+    SpecialEventQueue<EventType, HandlerType, MoodycamelQueue<Event>>;
+
+using SegmentedSpecialQueue =
+    SpecialEventQueue<EventType, HandlerType, SegmentedQueue<Event>>;
+
+/**
+ * @brief The resident set size of this process.
+ * @return The size in bytes, or 0 if it cannot be read.
+ */
+static double residentBytes() {
+    std::ifstream statm("/proc/self/statm");
+    std::int64_t size = 0;
+    std::int64_t resident = 0;
+    if (!(statm >> size >> resident)) {
+        return 0;
+    }
+    return static_cast<double>(resident) *
+           static_cast<double>(sysconf(_SC_PAGESIZE));
+}
+
+template <typename QueueType>
+static void BM_BurstMemory(benchmark::State& state) {
+    const auto burst = state.range(0);
+    const int steadyRounds = 1000;
+    const int steadyEvents = 4;
+
+    for (auto _ : state) {
+        auto queue = std::make_unique<QueueType>();
+        std::int64_t processed = 0;
+        queue->appendListener(EventType::A,
+                              [&processed](const Event&) { ++processed; });
+
+        const double before = residentBytes();
+        state.counters["Rss_Before"] = before;
+        for (std::int64_t i = 0; i < burst; ++i) {
+            queue->enqueue(EventType::A, Event{EventType::A, {}});
+        }
+        state.counters["Rss_Peak"] = residentBytes();
+        while (queue->processBatch(4096) != 0) {  // NOLINT
+        }
+        state.counters["Rss_Drained"] = residentBytes();
+
+        for (int round = 0; round < steadyRounds; ++round) {
+            for (int i = 0; i < steadyEvents; ++i) {
+                queue->enqueue(EventType::A, Event{EventType::A, {}});
+            }
+            queue->processBatch(steadyEvents);
+        }
+        const double steady = residentBytes();
+        state.counters["Rss_Steady"] = steady;
+        state.counters["Rss_Kept"] = steady - before;
+        benchmark::DoNotOptimize(processed);
+    }
+    state.SetItemsProcessed(burst * state.iterations());
+}
+
+BENCHMARK_TEMPLATE(BM_BurstMemory, NaiveSpecialQueue)
+    ->Arg(1 << 20)
+    ->Iterations(1);
+BENCHMARK_TEMPLATE(BM_BurstMemory, ConcurrentSpecialQueue)
+    ->Arg(1 << 20)
+    ->Iterations(1);
+BENCHMARK_TEMPLATE(BM_BurstMemory, SegmentedSpecialQueue)
+    ->Arg(1 << 20)
+    ->Iterations(1);
@@ -0,0 +1,125 @@
+#ifndef DISPATCH_OPTIONS_H
+#define DISPATCH_OPTIONS_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "IdleStrategy.h"
+#include "ThreadPlacement.h"
+
+namespace eventTree::eventHubs {
+
+/**
+ * @enum DispatchMode
+ * @brief Selects how a hub's dispatch thread consumes its queue.
+ */
+enum class DispatchMode : std::uint8_t {
+    PollOne, /**< Process at most one event, then idle. */
+    Drain    /**< Process events until the queue is empty, then idle. */
+};
+
+/**
+ * @struct ElasticOptions
+ * @brief Lets SpecialHub grow and shrink its worker pool with the backlog.
+ *
+ * A supervisor samples the queue depth and estimates the age of the oldest
+ * event as depth divided by the recent dispatch rate. A worker is added when
+ * either signal stays over its threshold for scaleUpAfter, and one is retired
+ * when the queue stays empty for retireAfter. No two decisions are closer than
+ * cooldown, which together with the separate thresholds prevents thrashing.
+ */
+struct ElasticOptions {
+    /**
+     * @brief Upper bound of the pool. Scaling is disabled unless this is
+     * greater than DispatchOptions::workers, which is the lower bound.
+     */
+    std::size_t maxWorkers = 0;
+
+    /** @brief Queue depth that counts as backlog pressure. */
+    std::size_t scaleUpDepth = 1024;  // NOLINT
+
+    /** @brief Estimated oldest-event age that counts as backlog pressure. */
+    std::chrono::milliseconds scaleUpAge{50};  // NOLINT
+
+    /** @brief How long pressure must last before a worker is added. */
+    std::chrono::milliseconds scaleUpAfter{5};  // NOLINT
+
+    /** @brief How long the queue must stay empty before a worker retires. */
+    std::chrono::milliseconds retireAfter{500};  // NOLINT
+
+    /** @brief Minimum time between two scaling decisions. */
+    std::chrono::milliseconds cooldown{20};  // NOLINT
+
+    /** @brief How often the supervisor samples the queue. */
+    std::chrono::milliseconds sampleInterval{1};
+};
+
+/**
+ * @struct ScalingStats
+ * @brief Scaling decisions of an elastic worker pool.
+ */
+struct ScalingStats {
+    std::size_t workers = 0;       /**< Current number of workers. */
+    std::uint64_t scaleUps = 0;    /**< Workers added so far. */
+    std::uint64_t scaleDowns = 0;  /**< Workers retired so far. */
+    std::size_t lastDepth = 0;     /**< Queue depth at the last sample. */
+
+    /** @brief Estimated oldest-event age at the last sample. */
+    std::chrono::microseconds lastBacklogAge{0};
+};
+
+/**
+ * @struct DispatchOptions
+ * @brief Tunes the dispatch loop of an event hub.
+ *
+ * In Drain mode each pass processes events in fair round-robin order until
+ * the queue is empty or either budget runs out. The hub only idles when a
+ * pass found the queue empty; an exhausted budget just gives the loop a
+ * chance to notice shutdown before the next pass. How an idle hub waits is
+ * chosen by the idle strategy; by default it blocks until the next event is
+ * emitted.
+ */
+struct DispatchOptions {
+    /** @brief How the dispatch threads consume the queue. */
+    DispatchMode mode = DispatchMode::Drain;
+
+    /** @brief Number of dispatch threads; only SpecialHub runs several. */
+    std::size_t workers = 1;
+
+    /** @brief Maximum number of events processed in one drain pass. */
+    std::size_t batchEvents = 1024;  // NOLINT
+
+    /** @brief Maximum time spent in one drain pass. */
+    std::chrono::microseconds batchTime{1000};  // NOLINT
+
+    /**
+     * @brief How long to sleep between polls in PollOne mode, and the
+     * longest a parked EventppHub waits before rechecking for shutdown.
+     */
+    std::chrono::milliseconds idleSleep{10};  // NOLINT
+
+    /** @brief How to wait in Drain mode when a pass finds no events. */
+    IdleOptions idle;
+
+    /** @brief Backlog-driven scaling of the pool. SpecialHub only. */
+    ElasticOptions elastic;
+
+    /**
+     * @brief How often a priority lane with events may be passed over by
+     * more urgent lanes before it is served anyway; 0 lets urgent events
+     * starve the others. SpecialHub only.
+     */
+    std::size_t priorityAging = 0;
+
+    /**
+     * @brief CPU affinity and scheduling class of the dispatch threads, by
+     * worker index. Workers without an entry are left to the scheduler.
+     */
+    std::vector<ThreadPlacement> placement;
+};
+
+}  // namespace eventTree::eventHubs
+
+#endif  // DISPATCH_OPTIONS_H
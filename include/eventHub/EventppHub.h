@@ -7,7 +7,9 @@
 #include <functional>
 #include <thread>
 
+#include "DispatchOptions.h"
 #include "IEventHub.h"
+#include "IdleStrategy.h"
 #include "events/Event.h"
 
 namespace eventTree::eventHubs {
@@ -24,12 +26,14 @@ class EventppHub : public IEventHub {
    private:
     /** @brief Type alias for the event queue used internally. */
     using EventQueue =
-        eventpp::EventQueue<events::EventType, void(events::EventPtr),
+        eventpp::EventQueue<events::EventType, void(const events::EventPtr&),
                             events::EventPolicy>;
 
     EventQueue queue; /**< The event queue for storing and processing events. */
-    std::thread dispatch_thread;     /**< Thread for dispatching events. */
+    DispatchOptions options;         /**< Settings of the dispatch loop. */
     std::atomic<bool> running{true}; /**< Flag to control the dispatch loop. */
+    IdleStrategy idleStrategy;       /**< Waits when there are no events. */
+    std::thread dispatch_thread;     /**< Thread for dispatching events. */
 
     /**
      * @brief Private method to dispatch events from the queue.
@@ -41,11 +45,13 @@ class EventppHub : public IEventHub {
 
    public:
     /**
-     * @brief Default constructor.
+     * @brief Constructor.
      *
      * Initializes the event queue and starts the dispatch thread.
+     *
+     * @param options Settings of the dispatch loop.
      */
-    EventppHub();
+    explicit EventppHub(DispatchOptions options = {});
 
     /**
      * @brief Destructor.
@@ -54,6 +60,9 @@ class EventppHub : public IEventHub {
      */
     ~EventppHub() override;
 
+    /** @brief The producer-tagged overload, which ignores the producer. */
+    using IEventHub::emitEvent;
+
     /**
      * @brief Emits an event to be processed by registered handlers.
      * @param type The type of event to handle.
@@ -61,13 +70,21 @@ class EventppHub : public IEventHub {
      */
     void emitEvent(events::EventType type, events::EventPtr event) override;
 
+    /** @brief The overload for handlers of the event itself. */
+    using IEventHub::registerHandler;
+
     /**
      * @brief Registers a handler function for a specific event type.
      * @param type The type of event to handle.
      * @param func The handler function to be called when the event occurs.
      */
-    void registerHandler(events::EventType type,
-                         std::function<void(events::EventPtr)> func) override;
+    void registerHandler(events::EventType type, EventHandler func) override;
+
+    /**
+     * @brief Statistics of the dispatch thread's idle strategy.
+     * @return The number of empty polls and the time spent idling.
+     */
+    [[nodiscard]] IdleStats idleStats() const;
 
     // Special constructors to comply with "rule of 5"
     EventppHub(const EventppHub&) = delete;
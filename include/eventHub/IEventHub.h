@@ -1,12 +1,88 @@
 #ifndef IEVENT_HUB_H
 #define IEVENT_HUB_H
 
+#include <concepts>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "events/Event.h"
 
 namespace eventTree::eventHubs {
 
+/**
+ * @typedef ProducerId
+ * @brief Identifies the producer of an event. Zero stands for an anonymous
+ * producer.
+ */
+using ProducerId = std::uint64_t;
+
+/**
+ * @typedef EventHandler
+ * @brief A handler of events emitted to a hub.
+ *
+ * The event is borrowed from the hub's queue for the duration of the call, so
+ * running the handlers of an event touches its reference count only when a
+ * handler keeps a copy. Handlers taking an EventPtr by value still convert,
+ * at the cost of that copy on every call.
+ */
+using EventHandler = std::function<void(const events::EventPtr&)>;
+
+/**
+ * @enum Priority
+ * @brief How urgently an event must be handled.
+ */
+enum class Priority : std::uint8_t {
+    High,   /**< Jumps ahead of any backlog, e.g. emergency alerts. */
+    Normal, /**< The default. */
+    Low     /**< Handled when nothing more urgent is waiting. */
+};
+
+/**
+ * @class EmitHandle
+ * @brief Emits the events of a single producer.
+ *
+ * A handle may keep per-producer state of its hub, such as queue tokens, so
+ * it must only be used by one thread at a time and must not outlive the hub.
+ */
+class EmitHandle {
+   public:
+    /**
+     * @brief Virtual destructor.
+     *
+     * Ensures proper cleanup of derived classes.
+     */
+    virtual ~EmitHandle() = default;
+
+    /**
+     * @brief Emits an event with a priority.
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     * @param priority How urgently the event must be handled.
+     */
+    virtual void emitEvent(events::EventType type, events::EventPtr event,
+                           Priority priority) = 0;
+
+    /**
+     * @brief Emits an event with normal priority.
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     */
+    void emitEvent(events::EventType type, events::EventPtr event) {
+        emitEvent(type, std::move(event), Priority::Normal);
+    }
+
+    // Special constructors to comply with "rule of 5"
+
+    EmitHandle() = default;
+    EmitHandle(const EmitHandle&) = delete;
+    EmitHandle& operator=(const EmitHandle&) = delete;
+    EmitHandle(EmitHandle&&) noexcept = delete;
+    EmitHandle& operator=(EmitHandle&&) noexcept = delete;
+};
+
 /**
  * @class IEventHub
  * @brief Interface for event hub implementations.
@@ -31,13 +107,86 @@ class IEventHub {
      */
     virtual void emitEvent(events::EventType type, events::EventPtr event) = 0;
 
+    /**
+     * @brief Emits an event on behalf of a producer.
+     *
+     * Hubs that schedule fairly across producers override this; the default
+     * ignores the producer.
+     *
+     * @param producer The producer emitting the event.
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     */
+    virtual void emitEvent(ProducerId producer, events::EventType type,
+                           events::EventPtr event) {
+        static_cast<void>(producer);
+        emitEvent(type, std::move(event));
+    }
+
+    /**
+     * @brief Emits an event with a priority.
+     *
+     * Hubs with priority lanes override this; the default ignores the
+     * priority.
+     *
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     * @param priority How urgently the event must be handled.
+     */
+    virtual void emitEvent(events::EventType type, events::EventPtr event,
+                           Priority priority) {
+        static_cast<void>(priority);
+        emitEvent(type, std::move(event));
+    }
+
+    /**
+     * @brief Emits an event with a priority on behalf of a producer.
+     * @param producer The producer emitting the event.
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     * @param priority How urgently the event must be handled.
+     */
+    virtual void emitEvent(ProducerId producer, events::EventType type,
+                           events::EventPtr event, Priority priority) {
+        static_cast<void>(priority);
+        emitEvent(producer, type, std::move(event));
+    }
+
+    /**
+     * @brief Opens a handle that emits events on behalf of a producer.
+     *
+     * Hubs that can keep per-producer state, such as queue tokens, override
+     * this; the default handle calls emitEvent() with the producer.
+     *
+     * @param producer The producer emitting through the handle.
+     * @return The handle.
+     */
+    virtual std::unique_ptr<EmitHandle> openEmitHandle(ProducerId producer);
+
     /**
      * @brief Pure virtual function to register an event handler.
      * @param type The type of event to handle.
      * @param func The handler function to be called when the event occurs.
      */
-    virtual void registerHandler(
-        events::EventType type, std::function<void(events::EventPtr)> func) = 0;
+    virtual void registerHandler(events::EventType type, EventHandler func) = 0;
+
+    /**
+     * @brief Registers a handler that receives the event itself rather than
+     * a pointer to it.
+     * @tparam F The type of the handler function.
+     * @param type The type of event to handle.
+     * @param func The handler function to be called when the event occurs.
+     */
+    template <typename F>
+        requires(!std::invocable<std::decay_t<F>&, const events::EventPtr&>) &&
+                std::invocable<std::decay_t<F>&, const events::Event&>
+    void registerHandler(events::EventType type, F&& func) {
+        registerHandler(
+            type, EventHandler([func = std::forward<F>(func)](
+                                   const events::EventPtr& event) mutable {
+                func(*event);
+            }));
+    }
 
     // Special constructors to comply with "rule of 5"
 
@@ -48,6 +197,44 @@ class IEventHub {
     IEventHub& operator=(IEventHub&&) noexcept = default;
 };
 
+/**
+ * @class ForwardingEmitHandle
+ * @brief The default EmitHandle, which forwards to its hub.
+ */
+class ForwardingEmitHandle : public EmitHandle {
+   private:
+    IEventHub& hub;      /**< The hub events are emitted to. */
+    ProducerId producer; /**< The producer they are emitted for. */
+
+   public:
+    /**
+     * @brief Constructor.
+     * @param hub The hub events are emitted to.
+     * @param producer The producer they are emitted for.
+     */
+    ForwardingEmitHandle(IEventHub& hub, ProducerId producer)
+        : hub(hub), producer(producer) {}
+
+    /** @brief The overload with normal priority. */
+    using EmitHandle::emitEvent;
+
+    /**
+     * @brief Emits an event with a priority on behalf of the producer.
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     * @param priority How urgently the event must be handled.
+     */
+    void emitEvent(events::EventType type, events::EventPtr event,
+                   Priority priority) override {
+        hub.emitEvent(producer, type, std::move(event), priority);
+    }
+};
+
+inline std::unique_ptr<EmitHandle> IEventHub::openEmitHandle(
+    ProducerId producer) {
+    return std::make_unique<ForwardingEmitHandle>(*this, producer);
+}
+
 }  // namespace eventTree::eventHubs
 
 #endif  // IEVENT_HUB_H
\ No newline at end of file
@@ -0,0 +1,180 @@
+#ifndef IDLE_STRATEGY_H
+#define IDLE_STRATEGY_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <utility>
+
+namespace eventTree::eventHubs {
+
+/**
+ * @enum IdleStrategyKind
+ * @brief How a dispatch thread waits when a pass finds no events.
+ */
+enum class IdleStrategyKind : std::uint8_t {
+    BusySpin,      /**< Spin on the CPU, lowest latency, one full core. */
+    SpinThenYield, /**< Spin for a while, then yield the time slice. */
+    Backoff,       /**< Spin, yield, then sleep with exponential backoff. */
+    Park           /**< Block until an event is emitted. */
+};
+
+/**
+ * @struct IdleOptions
+ * @brief Tunes an IdleStrategy.
+ */
+struct IdleOptions {
+    /** @brief The idle strategy to use. */
+    IdleStrategyKind kind = IdleStrategyKind::Park;
+
+    /** @brief Empty polls spent spinning before yielding or sleeping. */
+    std::uint32_t spins = 100;  // NOLINT
+
+    /** @brief Empty polls spent yielding before Backoff starts sleeping. */
+    std::uint32_t yields = 10;  // NOLINT
+
+    /** @brief First sleep of the Backoff strategy. */
+    std::chrono::microseconds minBackoff{1};
+
+    /** @brief Longest sleep of the Backoff strategy. */
+    std::chrono::microseconds maxBackoff{1000};  // NOLINT
+};
+
+/**
+ * @struct IdleStats
+ * @brief What a dispatch thread did while it had nothing to process.
+ */
+struct IdleStats {
+    std::uint64_t emptyPolls = 0;         /**< Passes that found no events. */
+    std::chrono::nanoseconds idleTime{0}; /**< Time spent idling. */
+};
+
+/**
+ * @brief Hints the CPU that the caller is in a spin-wait loop.
+ */
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");  // NOLINT
+#endif
+}
+
+/**
+ * @class IdleStrategy
+ * @brief Decides how a dispatch thread waits between empty polls, and keeps
+ * statistics about it.
+ *
+ * Owned and driven by a single dispatch thread; stats() may be read from any
+ * thread.
+ */
+class IdleStrategy {
+   private:
+    IdleOptions options;
+    std::uint32_t emptyStreak = 0;
+    std::chrono::microseconds backoff;
+    std::atomic<std::uint64_t> emptyPolls{0};
+    std::atomic<std::int64_t> idleNanoseconds{0};
+
+    /**
+     * @brief Runs a wait and adds its duration to the idle time.
+     * @param wait The wait to run.
+     */
+    template <typename Wait>
+    void timed(Wait&& wait) {
+        auto start = std::chrono::steady_clock::now();
+        std::invoke(std::forward<Wait>(wait));
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        idleNanoseconds.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count(),
+            std::memory_order_relaxed);
+    }
+
+   public:
+    /**
+     * @brief Constructs a strategy.
+     * @param options The strategy and its tuning.
+     */
+    explicit IdleStrategy(IdleOptions options)
+        : options(options), backoff(options.minBackoff) {}
+
+    /**
+     * @brief Waits after a poll that found no events.
+     *
+     * @tparam Park A callable that blocks until events may be available.
+     * @param park Used by the Park strategy only.
+     */
+    template <typename Park>
+    void idle(Park&& park) {
+        emptyPolls.fetch_add(1, std::memory_order_relaxed);
+        auto streak = emptyStreak;
+        if (emptyStreak != std::numeric_limits<std::uint32_t>::max()) {
+            ++emptyStreak;
+        }
+
+        // Spinning polls are too short to be worth two clock reads; only the
+        // waits that give up the CPU are timed.
+        switch (options.kind) {
+            case IdleStrategyKind::BusySpin:
+                cpuRelax();
+                return;
+            case IdleStrategyKind::SpinThenYield:
+                if (streak < options.spins) {
+                    cpuRelax();
+                    return;
+                }
+                timed([] { std::this_thread::yield(); });
+                return;
+            case IdleStrategyKind::Backoff:
+                if (streak < options.spins) {
+                    cpuRelax();
+                    return;
+                }
+                if (streak < options.spins + options.yields) {
+                    timed([] { std::this_thread::yield(); });
+                    return;
+                }
+                timed([this] { std::this_thread::sleep_for(backoff); });
+                backoff = std::min(backoff * 2, options.maxBackoff);
+                return;
+            case IdleStrategyKind::Park:
+                timed(std::forward<Park>(park));
+                return;
+        }
+    }
+
+    /**
+     * @brief Resets spin and backoff progress after a poll found events.
+     */
+    void reset() {
+        emptyStreak = 0;
+        backoff = options.minBackoff;
+    }
+
+    /**
+     * @brief The next sleep of the Backoff strategy.
+     */
+    [[nodiscard]] std::chrono::microseconds currentBackoff() const {
+        return backoff;
+    }
+
+    /**
+     * @brief Statistics collected so far.
+     * @return The number of empty polls and the time spent idling.
+     */
+    [[nodiscard]] IdleStats stats() const {
+        return IdleStats{
+            emptyPolls.load(std::memory_order_relaxed),
+            std::chrono::nanoseconds(
+                idleNanoseconds.load(std::memory_order_relaxed))};
+    }
+};
+
+}  // namespace eventTree::eventHubs
+
+#endif  // IDLE_STRATEGY_H
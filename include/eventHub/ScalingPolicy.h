@@ -0,0 +1,135 @@
+#ifndef SCALING_POLICY_H
+#define SCALING_POLICY_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "DispatchOptions.h"
+
+namespace eventTree::eventHubs {
+
+/**
+ * @enum ScalingDecision
+ * @brief What a ScalingPolicy asks the pool to do after a sample.
+ */
+enum class ScalingDecision : std::uint8_t {
+    Keep,     /**< Leave the pool as it is. */
+    ScaleUp,  /**< Start one more worker. */
+    ScaleDown /**< Retire one worker. */
+};
+
+/**
+ * @class ScalingPolicy
+ * @brief The hysteresis of an elastic worker pool, see ElasticOptions.
+ *
+ * Fed with periodic samples of the queue depth and the number of events
+ * processed so far, it decides when to add or retire a worker. It keeps no
+ * threads or clocks of its own, so it can be driven with any timeline.
+ */
+class ScalingPolicy {
+   public:
+    using Clock = std::chrono::steady_clock;  ///< The clock of the samples.
+
+   private:
+    ElasticOptions options;  ///< Thresholds and delays.
+    std::size_t minWorkers;  ///< Lower bound of the pool.
+
+    Clock::time_point lastSample;    ///< Time of the previous sample.
+    Clock::time_point lastDecision;  ///< Time of the last resize.
+    Clock::time_point pressureSince = Clock::time_point::max();
+    Clock::time_point emptySince = Clock::time_point::max();
+    std::uint64_t lastProcessed = 0;  ///< Processed count at lastSample.
+
+    std::size_t depth = 0;                    ///< Depth at lastSample.
+    std::chrono::microseconds backlogAge{0};  ///< Age at lastSample.
+
+   public:
+    /**
+     * @brief Constructs a policy whose first cooldown starts at start.
+     * @param options Thresholds and delays.
+     * @param minWorkers Lower bound of the pool.
+     * @param start The time the pool was started.
+     */
+    ScalingPolicy(const ElasticOptions& options, std::size_t minWorkers,
+                  Clock::time_point start)
+        : options(options),
+          minWorkers(minWorkers),
+          lastSample(start),
+          lastDecision(start) {}
+
+    /**
+     * @brief Takes a sample and decides whether to resize the pool.
+     *
+     * The caller is expected to carry out the decision before the next
+     * sample.
+     *
+     * @param now The time of the sample.
+     * @param queueDepth Events waiting in the queue.
+     * @param processed Events processed by the pool so far, including
+     * retired workers.
+     * @param workers The current number of workers.
+     * @return The decision.
+     */
+    ScalingDecision sample(Clock::time_point now, std::size_t queueDepth,
+                           std::uint64_t processed, std::size_t workers) {
+        // Little's law: a backlog of `queueDepth` drained at the recent rate
+        // has been waiting for roughly queueDepth / rate.
+        auto elapsed = std::chrono::duration<double>(now - lastSample).count();
+        auto drained = static_cast<double>(processed - lastProcessed);
+        auto rate = elapsed > 0 ? drained / elapsed : 0.0;
+        auto age = std::chrono::microseconds::max();
+        if (queueDepth == 0) {
+            age = std::chrono::microseconds::zero();
+        } else if (rate > 0) {
+            age = std::chrono::microseconds(static_cast<std::int64_t>(
+                static_cast<double>(queueDepth) / rate * 1e6));  // NOLINT
+        }
+        lastSample = now;
+        lastProcessed = processed;
+        depth = queueDepth;
+        backlogAge = age;
+
+        auto pressure = queueDepth >= options.scaleUpDepth ||
+                        (queueDepth != 0 && age >= options.scaleUpAge);
+        pressureSince = pressure ? std::min(pressureSince, now)
+                                 : Clock::time_point::max();
+        emptySince = queueDepth == 0 ? std::min(emptySince, now)
+                                     : Clock::time_point::max();
+        if (now - lastDecision < options.cooldown) {
+            return ScalingDecision::Keep;
+        }
+
+        if (pressureSince != Clock::time_point::max() &&
+            now - pressureSince >= options.scaleUpAfter &&
+            workers < options.maxWorkers) {
+            lastDecision = now;
+            pressureSince = now;
+            return ScalingDecision::ScaleUp;
+        }
+        if (emptySince != Clock::time_point::max() &&
+            now - emptySince >= options.retireAfter && workers > minWorkers) {
+            lastDecision = now;
+            emptySince = now;
+            return ScalingDecision::ScaleDown;
+        }
+        return ScalingDecision::Keep;
+    }
+
+    /**
+     * @brief The queue depth of the last sample.
+     */
+    [[nodiscard]] std::size_t lastDepth() const { return depth; }
+
+    /**
+     * @brief The estimated oldest-event age of the last sample.
+     */
+    [[nodiscard]] std::chrono::microseconds lastBacklogAge() const {
+        return backlogAge;
+    }
+};
+
+}  // namespace eventTree::eventHubs
+
+#endif  // SCALING_POLICY_H
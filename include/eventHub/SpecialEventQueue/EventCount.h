@@ -0,0 +1,137 @@
+#ifndef EVENT_COUNT_H
+#define EVENT_COUNT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+namespace eventTree::eventHubs::detail {
+
+/**
+ * @class EventCount
+ * @brief Parks idle consumers of a queue until a producer may have events
+ * for them.
+ *
+ * A consumer registers itself as parked, checks for events and its stop
+ * condition once more, and only then sleeps on a futex-backed atomic wait.
+ * A producer calls wakeOne() after its event is visible to that check, so
+ * either it sees the parked consumer or the consumer sees the event before
+ * sleeping. Producers only pay for a wakeup while a consumer is registered,
+ * and each call wakes at most one.
+ *
+ * Every queue that consumers can wait on owns one.
+ */
+class EventCount {
+   private:
+    std::atomic<std::uint32_t> epoch{0};   ///< Bumped to wake waiters.
+    std::atomic<std::uint32_t> parked{0};  ///< Consumers in a wait.
+
+   public:
+    /**
+     * @brief Wakes one parked consumer, if there is any.
+     */
+    void wakeOne() {
+        if (parked.load() != 0) {
+            epoch.fetch_add(1);
+            epoch.notify_one();
+        }
+    }
+
+    /**
+     * @brief Wakes every parked consumer.
+     */
+    void wakeAll() {
+        epoch.fetch_add(1);
+        epoch.notify_all();
+    }
+
+    /**
+     * @brief Blocks the calling consumer until it is woken, unless there
+     * are events or it should stop already.
+     * @tparam HasEvents A callable returning true if events may be pending.
+     * @tparam Predicate A callable returning true when the wait should end
+     * regardless of pending events, e.g. on shutdown.
+     * @param hasEvents Checks the queue for events.
+     * @param shouldStop The stop condition. Whoever makes it true must call
+     * wakeAll() afterwards.
+     */
+    template <typename HasEvents, typename Predicate>
+    void wait(HasEvents&& hasEvents, Predicate&& shouldStop) {
+        auto seen = epoch.load();
+        parked.fetch_add(1);
+        if (!std::invoke(hasEvents) && !std::invoke(shouldStop)) {
+            epoch.wait(seen);
+        }
+        parked.fetch_sub(1);
+    }
+};
+
+/**
+ * @brief The loop behind every queue's processBatch() and processFor().
+ *
+ * @tparam ProcessSome A callable taking the number of events still allowed
+ * and returning how many it handled; 0 means the queue is empty.
+ * @tparam Done A callable returning true when the loop should stop early.
+ * @param maxEvents The maximum number of events to process.
+ * @param processSome Handles the next event or burst of events.
+ * @param done Checked after every call that handled events.
+ * @return The number of events processed.
+ */
+template <typename ProcessSome, typename Done>
+std::size_t drainEvents(std::size_t maxEvents, ProcessSome&& processSome,
+                        Done&& done) {
+    std::size_t processed = 0;
+    while (processed < maxEvents) {
+        std::size_t handled = std::invoke(processSome, maxEvents - processed);
+        if (handled == 0) {
+            break;
+        }
+        processed += handled;
+        if (std::invoke(done)) {
+            break;
+        }
+    }
+    return processed;
+}
+
+/**
+ * @brief Drains events until the queue is empty or a count is reached.
+ * @tparam ProcessSome See drainEvents().
+ * @param maxEvents The maximum number of events to process.
+ * @param processSome Handles the next event or burst of events.
+ * @return The number of events processed.
+ */
+template <typename ProcessSome>
+std::size_t drainEvents(std::size_t maxEvents, ProcessSome&& processSome) {
+    return drainEvents(maxEvents, std::forward<ProcessSome>(processSome),
+                       [] { return false; });
+}
+
+/**
+ * @brief Drains events until the queue is empty, a count is reached or a
+ * time budget runs out.
+ *
+ * The budget is checked after each call to processSome, so a slow handler
+ * can overrun it by at most its own duration.
+ *
+ * @tparam ProcessSome See drainEvents().
+ * @param budget The maximum time to spend processing.
+ * @param maxEvents The maximum number of events to process.
+ * @param processSome Handles the next event or burst of events.
+ * @return The number of events processed.
+ */
+template <typename Rep, typename Period, typename ProcessSome>
+std::size_t drainEventsFor(const std::chrono::duration<Rep, Period>& budget,
+                           std::size_t maxEvents, ProcessSome&& processSome) {
+    auto deadline = std::chrono::steady_clock::now() + budget;
+    return drainEvents(maxEvents, std::forward<ProcessSome>(processSome), [&] {
+        return std::chrono::steady_clock::now() >= deadline;
+    });
+}
+
+}  // namespace eventTree::eventHubs::detail
+
+#endif  // EVENT_COUNT_H
@@ -0,0 +1,229 @@
+#ifndef EVENT_SLOT_H
+#define EVENT_SLOT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace eventTree::eventHubs::detail {
+
+/**
+ * @struct Timed
+ * @brief An event stored together with the time after which it is worthless.
+ * @tparam T The type of the event.
+ */
+template <typename T>
+struct Timed {
+    using Deadline = std::chrono::steady_clock::time_point;
+
+    T event;                               ///< The event itself.
+    Deadline deadline = Deadline::max();  ///< max() means it never expires.
+};
+
+/**
+ * @struct RebindQueue
+ * @brief Names the same queue template with a different element type.
+ * @tparam Queue A queue template instantiated with a single element type.
+ * @tparam U The new element type.
+ */
+template <typename Queue, typename U>
+struct RebindQueue;
+
+template <template <typename> typename Queue, typename T, typename U>
+struct RebindQueue<Queue<T>, U> {
+    using type = Queue<U>;  ///< The rebound queue.
+};
+
+template <template <typename, std::size_t> typename Queue, typename T,
+          std::size_t Capacity, typename U>
+struct RebindQueue<Queue<T, Capacity>, U> {
+    using type = Queue<U, Capacity>;  ///< The rebound queue.
+};
+
+/**
+ * @brief Concept for queues that are built for one particular event type,
+ * such as a MappedQueue choosing its backend from the type.
+ * @tparam Q The queue type to check.
+ * @tparam EventType The type used to identify different events.
+ */
+template <typename Q, typename EventType>
+concept KeyedQueueConcept =
+    std::same_as<typename Q::key_type, EventType> &&
+    std::constructible_from<Q, const EventType&>;
+
+/**
+ * @class HandlerList
+ * @brief An append-only list of handlers that can be invoked while new
+ * handlers are being registered.
+ *
+ * @tparam HandlerType The type of the event handlers.
+ *
+ * Handlers are stored in chunks that are never reallocated, so they can be
+ * move-only. The first chunk holds the first firstChunkSize handlers side by
+ * side and each further chunk doubles the capacity, so the handlers of a type
+ * are usually walked as a single array.
+ *
+ * Registration is rare and takes a mutex; invocation is lock-free and only
+ * walks the prefix of handlers that has been fully constructed and published.
+ */
+template <typename HandlerType>
+class HandlerList {
+   private:
+    /** @brief The capacity of the first chunk. */
+    static constexpr std::size_t firstChunkSize = 8;
+
+    /**
+     * @struct Chunk
+     * @brief Contiguous storage for a number of handlers.
+     */
+    struct Chunk {
+        /**
+         * @brief Reserves storage for the given number of handlers.
+         * @param capacity The number of handlers the chunk holds.
+         */
+        explicit Chunk(std::size_t capacity) : capacity(capacity) {
+            storage.reserve(capacity);
+            handlers = storage.data();
+        }
+
+        std::vector<HandlerType> storage;  ///< Never grows past capacity.
+        HandlerType* handlers;             ///< Read by invoke().
+        std::size_t capacity;              ///< Handlers the chunk holds.
+        std::unique_ptr<Chunk> next;       ///< The following chunk.
+    };
+
+    std::unique_ptr<Chunk> head;            ///< The first chunk.
+    Chunk* tail = nullptr;                  ///< The chunk appended to.
+    std::atomic<std::size_t> published{0};  ///< Handlers ready to run.
+    std::mutex mutex;                       ///< Guards registration.
+
+   public:
+    /**
+     * @brief Appends a handler to the list.
+     * @tparam H The type of the handler function.
+     * @param handler The handler function to add.
+     */
+    template <typename H>
+    void append(H&& handler) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tail == nullptr) {
+            head = std::make_unique<Chunk>(firstChunkSize);
+            tail = head.get();
+        } else if (tail->storage.size() == tail->capacity) {
+            tail->next = std::make_unique<Chunk>(2 * tail->capacity);
+            tail = tail->next.get();
+        }
+        tail->storage.emplace_back(std::forward<H>(handler));
+        published.store(published.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_release);
+    }
+
+    /**
+     * @brief Invokes every published handler with the given event.
+     * @tparam Event The type of the event.
+     * @param event The event passed to each handler.
+     */
+    template <typename Event>
+    void invoke(const Event& event) {
+        auto count = published.load(std::memory_order_acquire);
+        if (count == 0) {
+            return;
+        }
+        // Only follow next once the published count reaches past a chunk, so
+        // that a chunk being appended is never read.
+        for (auto* chunk = head.get();; chunk = chunk->next.get()) {
+            auto chunkCount = std::min(count, chunk->capacity);
+            for (std::size_t index = 0; index < chunkCount; ++index) {
+                std::invoke(chunk->handlers[index], event);
+            }
+            count -= chunkCount;
+            if (count == 0) {
+                return;
+            }
+        }
+    }
+};
+
+/**
+ * @struct EventSlot
+ * @brief Everything SpecialEventQueue keeps for a single event type.
+ *
+ * @tparam EventType The type used to identify different events.
+ * @tparam HandlerType The type of the event handlers.
+ * @tparam QueueType The type of queue used to store events, as Timed values.
+ *
+ * Slots are never moved or destroyed while the owning queue is alive, so
+ * references to them stay valid and can be used on the hot paths instead of
+ * looking the event type up again.
+ */
+template <typename EventType, typename HandlerType, typename QueueType>
+struct EventSlot {
+    /**
+     * @brief Constructs an empty slot for the given event type.
+     * @param type The event type this slot belongs to.
+     * @param index The position of this slot in round-robin order.
+     */
+    EventSlot(const EventType& type, std::size_t index)
+        : type(type), index(index) {}
+
+    /**
+     * @brief Constructs an empty slot whose queue is built for its type.
+     * @param type The event type this slot belongs to.
+     * @param index The position of this slot in round-robin order.
+     */
+    EventSlot(const EventType& type, std::size_t index)
+        requires KeyedQueueConcept<QueueType, EventType>
+        : type(type), index(index), queue(type) {}
+
+    EventType type;                     ///< The event type of this slot.
+    std::size_t index;                  ///< Position in round-robin order.
+    QueueType queue;                    ///< Pending events of this type.
+    HandlerList<HandlerType> handlers;  ///< Handlers of this type.
+
+    /**
+     * @brief Number of events pushed, or about to be pushed, and not yet
+     * popped. Drives the ready bit of this slot.
+     */
+    std::atomic<std::size_t> pending{0};
+
+    /**
+     * @brief Held by the consumer running this slot's handlers when the
+     * queue dispatches each type serially.
+     */
+    std::atomic<bool> owned{false};
+
+    /** @brief Share of this type under deficit round robin. */
+    std::atomic<std::uint32_t> weight{1};
+
+    /**
+     * @brief Credit left in the current deficit round robin round, in events
+     * or nanoseconds. Negative after a handler overran its credit.
+     */
+    std::atomic<std::int64_t> deficit{0};
+
+    /** @brief Events dropped as expired or on overflow, never handled. */
+    std::atomic<std::uint64_t> dropped{0};
+
+    /** @brief The type's OverflowPolicy, used while its queue is full. */
+    std::atomic<std::uint8_t> overflow{0};
+
+    /**
+     * @brief The next event, taken off the queue so its deadline can be
+     * compared with other types'. Only used by earliest-deadline scheduling.
+     */
+    std::optional<typename QueueType::value_type> head;
+    std::mutex headMutex;  ///< Guards head.
+};
+
+}  // namespace eventTree::eventHubs::detail
+
+#endif  // EVENT_SLOT_H
@@ -0,0 +1,167 @@
+/**
+ * @file InplaceFunction.h
+ * @brief A move-only function wrapper that keeps its target in a fixed-size
+ * buffer and never allocates.
+ */
+
+#ifndef INPLACE_FUNCTION_H
+#define INPLACE_FUNCTION_H
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace eventTree::eventHubs {
+
+/**
+ * @brief Concept for callables that an InplaceFunction can store in its
+ * buffer.
+ *
+ * The callable must fit into Capacity bytes, need no stricter alignment than
+ * std::max_align_t, and be movable without throwing, so that handler lists can
+ * move it around.
+ *
+ * @tparam F The callable type to check.
+ * @tparam Capacity The size of the buffer.
+ */
+template <typename F, std::size_t Capacity>
+concept InplaceStorableConcept =
+    sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) &&
+    std::is_nothrow_move_constructible_v<F>;
+
+template <typename Signature, std::size_t Capacity = 32>  // NOLINT
+class InplaceFunction;
+
+/**
+ * @class InplaceFunction
+ * @brief A move-only, allocation-free replacement for std::function, meant
+ * as the HandlerType of a SpecialEventQueue.
+ *
+ * @tparam R The return type.
+ * @tparam Args The parameter types.
+ * @tparam Capacity The size of the buffer holding the callable.
+ *
+ * The callable is stored inside the object, so a HandlerList of
+ * InplaceFunctions keeps each handler's captures next to the others. A
+ * callable that does not fit is rejected at compile time instead of falling
+ * back to the heap. Calls go through a single function pointer kept in the
+ * object itself.
+ *
+ * Queues that copy their handlers, such as ProducerFairEventQueue and
+ * PriorityEventQueue, need a copyable HandlerType instead.
+ */
+template <typename R, typename... Args, std::size_t Capacity>
+class InplaceFunction<R(Args...), Capacity> {
+   private:
+    using Invoker = R (*)(void*, Args&&...);
+
+    /**
+     * @struct Operations
+     * @brief How to move and destroy the stored callable.
+     */
+    struct Operations {
+        /** @brief Move-constructs target from source. */
+        void (*move)(void* target, void* source) noexcept;
+
+        /** @brief Destroys the callable. */
+        void (*destroy)(void* callable) noexcept;
+    };
+
+    template <typename F>
+    static R invoke(void* callable, Args&&... args) {
+        return std::invoke(*static_cast<F*>(callable),
+                           std::forward<Args>(args)...);
+    }
+
+    template <typename F>
+    static constexpr Operations operationsFor{
+        [](void* target, void* source) noexcept {
+            ::new (target) F(std::move(*static_cast<F*>(source)));
+            static_cast<F*>(source)->~F();
+        },
+        [](void* callable) noexcept { static_cast<F*>(callable)->~F(); }};
+
+    alignas(std::max_align_t) std::byte storage[Capacity];  // NOLINT
+    Invoker invoker = nullptr;               ///< Calls the callable.
+    const Operations* operations = nullptr;  ///< Moves and destroys it.
+
+    void reset() noexcept {
+        if (operations != nullptr) {
+            operations->destroy(storage);
+            invoker = nullptr;
+            operations = nullptr;
+        }
+    }
+
+   public:
+    /**
+     * @brief Constructs an empty InplaceFunction.
+     */
+    InplaceFunction() noexcept = default;
+
+    /**
+     * @brief Constructs an InplaceFunction holding a callable.
+     * @tparam F The type of the callable.
+     * @param callable The callable, moved or copied into the buffer.
+     */
+    template <typename F>
+        requires(!std::same_as<std::remove_cvref_t<F>, InplaceFunction>) &&
+                std::is_invocable_r_v<R, std::decay_t<F>&, Args...> &&
+                InplaceStorableConcept<std::decay_t<F>, Capacity>
+    InplaceFunction(F&& callable)  // NOLINT
+        : invoker(&invoke<std::decay_t<F>>),
+          operations(&operationsFor<std::decay_t<F>>) {
+        ::new (static_cast<void*>(storage))
+            std::decay_t<F>(std::forward<F>(callable));
+    }
+
+    /**
+     * @brief Calls the stored callable.
+     * @param args The arguments passed to it.
+     * @return What the callable returns.
+     */
+    R operator()(Args... args) {
+        assert(invoker != nullptr);
+        return invoker(storage, std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Checks whether a callable is stored.
+     */
+    explicit operator bool() const noexcept { return invoker != nullptr; }
+
+    ~InplaceFunction() { reset(); }
+
+    // Special constructors to comply with "rule of 5"
+    InplaceFunction(const InplaceFunction&) = delete;
+    InplaceFunction& operator=(const InplaceFunction&) = delete;
+
+    InplaceFunction(InplaceFunction&& other) noexcept
+        : invoker(other.invoker), operations(other.operations) {
+        if (operations != nullptr) {
+            operations->move(storage, other.storage);
+            other.invoker = nullptr;
+            other.operations = nullptr;
+        }
+    }
+
+    InplaceFunction& operator=(InplaceFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.operations != nullptr) {
+                other.operations->move(storage, other.storage);
+                invoker = std::exchange(other.invoker, nullptr);
+                operations = std::exchange(other.operations, nullptr);
+            }
+        }
+        return *this;
+    }
+};
+
+}  // namespace eventTree::eventHubs
+
+#endif  // INPLACE_FUNCTION_H
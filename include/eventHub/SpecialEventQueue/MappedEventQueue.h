@@ -0,0 +1,302 @@
+/**
+ * @file MappedEventQueue.h
+ * @brief A SpecialEventQueue that picks the queue backend of each event type
+ * at compile time.
+ */
+
+#ifndef MAPPED_EVENT_QUEUE_H
+#define MAPPED_EVENT_QUEUE_H
+
+#include <concepts>
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "EventSlot.h"
+#include "SpecialEventQueue.h"
+
+namespace eventTree::eventHubs {
+
+/**
+ * @struct QueueFor
+ * @brief One entry of a MappedQueue: the queue backend of one event type.
+ * @tparam Type The event type.
+ * @tparam Queue The queue storing events of that type.
+ */
+template <auto Type, typename Queue>
+struct QueueFor {
+    using key_type = decltype(Type);  ///< The type of the event types.
+    using queue_type = Queue;         ///< The queue of this event type.
+
+    static constexpr key_type type = Type;  ///< The event type.
+};
+
+/**
+ * @class MappedQueue
+ * @brief A queue whose backend is chosen by the event type it stores.
+ *
+ * @tparam Default The queue used by event types without an entry.
+ * @tparam Entries QueueFor entries, one per event type with its own queue.
+ *
+ * A MappedQueue owns exactly one backend, picked once when it is constructed
+ * for an event type and allocated on its own, so a type mapped to a small
+ * backend does not pay for the largest one. Every call is forwarded through
+ * std::visit over the backend pointers, a switch on the alternative the
+ * compiler generates; there are no virtual calls and each backend's calls can
+ * be inlined.
+ *
+ * It is a bounded queue if any backend is. Unbounded backends then accept
+ * every try_push(). It has bulk operations, which fall back to single pushes
+ * and pops for backends without them, but no tokens.
+ */
+template <typename Default, typename... Entries>
+    requires(sizeof...(Entries) > 0) && QueueConcept<Default> &&
+            (QueueConcept<typename Entries::queue_type> && ...) &&
+            (std::same_as<typename Entries::queue_type::value_type,
+                          typename Default::value_type> &&
+             ...)
+class MappedQueue {
+   public:
+    using value_type = typename Default::value_type;  ///< Stored elements.
+    using key_type = std::common_type_t<typename Entries::key_type...>;
+
+   private:
+    using Queues =
+        std::variant<std::unique_ptr<typename Entries::queue_type>...,
+                     std::unique_ptr<Default>>;
+
+    static constexpr std::size_t defaultIndex = sizeof...(Entries);
+
+    /** @brief Whether any backend can be full. */
+    static constexpr bool bounded =
+        (BoundedQueueConcept<typename Entries::queue_type> || ... ||
+         BoundedQueueConcept<Default>);
+
+    Queues queues;
+
+    /**
+     * @brief Constructs the backend of an event type, trying the entries
+     * from Index onwards.
+     * @param type The event type.
+     * @return The backend, constructed in place.
+     */
+    template <std::size_t Index>
+    static Queues select(const key_type& type) {
+        if constexpr (Index == defaultIndex) {
+            return make<Index>();
+        } else {
+            using Entry = std::tuple_element_t<Index, std::tuple<Entries...>>;
+            if (type == Entry::type) {
+                return make<Index>();
+            }
+            return select<Index + 1>(type);
+        }
+    }
+
+    /**
+     * @brief Allocates the backend of an alternative.
+     * @tparam Index The alternative.
+     * @return The backend.
+     */
+    template <std::size_t Index>
+    static Queues make() {
+        using Backend =
+            typename std::variant_alternative_t<Index, Queues>::element_type;
+        return Queues(std::in_place_index<Index>, std::make_unique<Backend>());
+    }
+
+    /**
+     * @brief Calls a function with the backend.
+     * @param function Called with a reference to the backend.
+     * @return What the function returns.
+     */
+    template <typename Function>
+    decltype(auto) visit(Function&& function) {
+        return std::visit(
+            [&function](auto& queue) -> decltype(auto) {
+                return function(*queue);
+            },
+            queues);
+    }
+
+    /** @copydoc visit */
+    template <typename Function>
+    decltype(auto) visit(Function&& function) const {
+        return std::visit(
+            [&function](const auto& queue) -> decltype(auto) {
+                return function(std::as_const(*queue));
+            },
+            queues);
+    }
+
+   public:
+    /**
+     * @brief Constructs the default backend.
+     */
+    MappedQueue() : queues(make<defaultIndex>()) {}
+
+    /**
+     * @brief Constructs the backend mapped to an event type.
+     * @param type The event type whose events the queue stores.
+     */
+    explicit MappedQueue(const key_type& type) : queues(select<0>(type)) {}
+
+    /**
+     * @brief Whether the chosen backend allows only one thread to pop.
+     * @return true for a single-consumer backend such as SpscRingQueue.
+     */
+    [[nodiscard]] bool single_consumer() const
+        requires(SingleConsumerQueueConcept<typename Entries::queue_type> ||
+                 ... || SingleConsumerQueueConcept<Default>)
+    {
+        return visit(
+            [](const auto& queue) {
+                using Queue = std::remove_cvref_t<decltype(queue)>;
+                if constexpr (SingleConsumerQueueConcept<Queue>) {
+                    return static_cast<bool>(queue.single_consumer());
+                } else {
+                    return false;
+                }
+            });
+    }
+
+    /**
+     * @brief Pushes an item into the backend, waiting if it is full.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param item The item to be pushed into the queue.
+     *
+     * @note This function is enabled only if U is convertible to value_type.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, value_type>
+    void push(U&& item) {
+        visit([&item](auto& queue) { queue.push(std::forward<U>(item)); });
+    }
+
+    /**
+     * @brief Attempts to push an item into the backend.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param item The item to be pushed into the queue. It is left untouched
+     * if the queue is full.
+     * @return true if the item was pushed, false if the queue was full.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, value_type> && bounded
+    bool try_push(U&& item) {
+        return visit(
+            [&item](auto& queue) {
+                using Queue = std::remove_reference_t<decltype(queue)>;
+                if constexpr (BoundedQueueConcept<Queue>) {
+                    return queue.try_push(std::forward<U>(item));
+                } else {
+                    queue.push(std::forward<U>(item));
+                    return true;
+                }
+            });
+    }
+
+    /**
+     * @brief Attempts to pop an item from the backend.
+     *
+     * @param[out] item The variable to store the popped item.
+     * @return true if an item was successfully popped, false if the queue was
+     * empty.
+     */
+    bool pop(value_type& item) {
+        return visit([&item](auto& queue) { return queue.pop(item); });
+    }
+
+    /**
+     * @brief Pushes several items into the backend.
+     *
+     * @tparam It An input iterator whose elements convert to value_type.
+     * @param first The first item to push.
+     * @param count The number of items to push.
+     */
+    template <typename It>
+    void push_bulk(It first, std::size_t count) {
+        visit(
+            [&first, count](auto& queue) mutable {
+                using Queue = std::remove_reference_t<decltype(queue)>;
+                if constexpr (BulkQueueConcept<Queue>) {
+                    queue.push_bulk(std::move(first), count);
+                } else {
+                    for (; count != 0; --count, ++first) {
+                        queue.push(*first);
+                    }
+                }
+            });
+    }
+
+    /**
+     * @brief Pops up to a number of items from the backend.
+     *
+     * @tparam It An output iterator accepting value_type.
+     * @param out Where the popped items are written.
+     * @param maxCount The maximum number of items to pop.
+     * @return The number of items popped.
+     */
+    template <typename It>
+    std::size_t pop_bulk(It out, std::size_t maxCount) {
+        return visit(
+            [&out, maxCount](auto& queue) -> std::size_t {
+                using Queue = std::remove_reference_t<decltype(queue)>;
+                if constexpr (BulkQueueConcept<Queue>) {
+                    return queue.pop_bulk(std::move(out), maxCount);
+                } else {
+                    std::size_t count = 0;
+                    for (value_type item;
+                         count < maxCount && queue.pop(item); ++count, ++out) {
+                        *out = std::move(item);
+                    }
+                    return count;
+                }
+            });
+    }
+};
+
+namespace detail {
+
+template <typename Default, typename... Entries, typename U>
+struct RebindQueue<MappedQueue<Default, Entries...>, U> {
+    /** @brief The rebound queue, with every backend rebound. */
+    using type = MappedQueue<
+        typename RebindQueue<Default, U>::type,
+        QueueFor<Entries::type, typename RebindQueue<
+                                    typename Entries::queue_type, U>::type>...>;
+};
+
+}  // namespace detail
+
+/**
+ * @brief A SpecialEventQueue whose event types each use the backend mapped
+ * to them, or Default.
+ *
+ * For example, bounded storage for a flooding type and a ring for a type with
+ * a single producer:
+ * @code
+ * MappedEventQueue<EventType, Handler, MoodycamelQueue<EventPtr>,
+ *                  QueueFor<EventType::Flood, BoundedMpmcQueue<EventPtr>>,
+ *                  QueueFor<EventType::Joy, SpscRingQueue<EventPtr>>>
+ * @endcode
+ *
+ * @tparam EventType The type used to identify different events.
+ * @tparam HandlerType The type of the event handlers.
+ * @tparam Default The queue of event types without an entry.
+ * @tparam Entries QueueFor entries keyed by EventType values.
+ */
+template <typename EventType, typename HandlerType, typename Default,
+          typename... Entries>
+    requires std::same_as<
+        typename MappedQueue<Default, Entries...>::key_type, EventType>
+using MappedEventQueue =
+    SpecialEventQueue<EventType, HandlerType, MappedQueue<Default, Entries...>>;
+
+}  // namespace eventTree::eventHubs
+
+#endif  // MAPPED_EVENT_QUEUE_H
@@ -0,0 +1,311 @@
+/**
+ * @file PriorityEventQueue.h
+ * @brief Strict priority lanes on top of the fair event queues.
+ */
+
+#ifndef PRIORITY_EVENT_QUEUE_H
+#define PRIORITY_EVENT_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <utility>
+
+#include "EventCount.h"
+#include "SpecialEventQueue.h"
+
+namespace eventTree::eventHubs {
+
+/**
+ * @struct PriorityCursor
+ * @brief The round-robin positions of a single consumer, one per priority
+ * lane.
+ *
+ * Every lane has its own layout of event types and producers, so serving one
+ * lane must not move the consumer's position in another.
+ *
+ * @tparam Lanes The number of lanes.
+ * @tparam LaneCursor The cursor type of a lane's queue.
+ */
+template <std::size_t Lanes, typename LaneCursor = DispatchCursor>
+struct PriorityCursor {
+    std::array<LaneCursor, Lanes> lanes{};  ///< Position in each lane.
+};
+
+/**
+ * @class PriorityEventQueue
+ * @brief A fixed number of priority lanes, each an independent fair queue.
+ *
+ * @tparam LaneQueue The queue of a single lane, e.g. a SpecialEventQueue or a
+ * ProducerFairEventQueue. Each lane keeps its own fair round robin.
+ * @tparam Lanes The number of lanes. Lane 0 has the highest priority.
+ *
+ * A higher lane is always served before a lower one. Optionally, a lower
+ * lane that has been passed over `agingBound` times while it had events is
+ * served once before the higher lanes again, which bounds its starvation.
+ *
+ * Handlers are registered once and apply to every lane.
+ */
+template <typename LaneQueue, std::size_t Lanes>
+    requires(Lanes > 0)
+class PriorityEventQueue {
+   private:
+    std::array<LaneQueue, Lanes> lanes;
+
+    /** @brief Times each lane was passed over while it had events. */
+    std::array<std::atomic<std::size_t>, Lanes> bypassed{};
+
+    /**
+     * @brief Events enqueued on each lane and not processed yet.
+     *
+     * Counted before the lane's enqueue, so it never falls below the lane's
+     * real backlog. Events a lane drops on its own, e.g. expired ones, are
+     * still counted; that only costs an early visit to an empty lane.
+     */
+    std::array<std::atomic<std::size_t>, Lanes> pending{};
+
+    std::size_t agingBound = 0;                     ///< 0 disables aging.
+    detail::EventCount eventCount;  ///< Parks idle consumers.
+
+    /**
+     * @brief Process one event of a lane.
+     * @tparam Cursor Either nothing, to use the lane's shared cursor, or
+     * PriorityCursor.
+     * @param lane The lane.
+     * @param cursor Optionally, the consumer's own cursors.
+     * @return true if an event was processed.
+     */
+    template <typename... Cursor>
+    bool processLane(std::size_t lane, Cursor&... cursor) {
+        if (!lanes[lane].processOne(cursor.lanes[lane]...)) {
+            return false;
+        }
+        pending[lane].fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Serves the highest non-empty lane, after any lane whose aging
+     * bound has been reached.
+     * @tparam Cursor Either nothing, to use the lanes' shared cursors, or
+     * PriorityCursor.
+     * @param cursor Optionally, the consumer's own cursors.
+     * @return true if an event was processed.
+     */
+    template <typename... Cursor>
+    bool processNext(Cursor&... cursor) {
+        if (agingBound != 0) {
+            // The lowest lane has waited longest relative to its priority.
+            for (std::size_t lane = Lanes; lane-- > 1;) {
+                if (bypassed[lane].load(std::memory_order_relaxed) <
+                    agingBound) {
+                    continue;
+                }
+                bypassed[lane].store(0, std::memory_order_relaxed);
+                if (processLane(lane, cursor...)) {
+                    return true;
+                }
+            }
+        }
+
+        for (std::size_t lane = 0; lane < Lanes; ++lane) {
+            if (!processLane(lane, cursor...)) {
+                continue;
+            }
+            if (agingBound != 0) {
+                for (auto lower = lane + 1; lower < Lanes; ++lower) {
+                    if (pending[lower].load(std::memory_order_relaxed) != 0) {
+                        bypassed[lower].fetch_add(1,
+                                                  std::memory_order_relaxed);
+                    }
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+   public:
+    /** @brief The type used to identify events. */
+    using key_type = typename LaneQueue::key_type;
+
+    /** @brief Number of priority lanes. */
+    static constexpr std::size_t laneCount = Lanes;
+
+    /** @brief The cursors a consumer keeps for this queue. */
+    using Cursor = PriorityCursor<Lanes, typename LaneQueue::Cursor>;
+
+    /**
+     * @brief Constructs a queue with strict priorities.
+     * @param agingBound How often a lane with events may be passed over by
+     * higher lanes before it is served anyway; 0 never serves it early.
+     */
+    explicit PriorityEventQueue(std::size_t agingBound = 0)
+        : agingBound(agingBound) {}
+
+    /**
+     * @brief Enqueue an event on a lane.
+     * @tparam Args The lane queue's enqueue arguments.
+     * @param lane The lane, less than Lanes; 0 is the most urgent.
+     * @param args Forwarded to the lane's enqueue(), e.g. type and event.
+     */
+    template <typename... Args>
+    void enqueue(std::size_t lane, Args&&... args) {
+        pending[lane].fetch_add(1, std::memory_order_relaxed);
+        using Result =
+            decltype(lanes[lane].enqueue(std::forward<Args>(args)...));
+        if constexpr (std::same_as<Result, EnqueueStatus>) {
+            if (lanes[lane].enqueue(std::forward<Args>(args)...) !=
+                EnqueueStatus::Enqueued) {
+                pending[lane].fetch_sub(1, std::memory_order_relaxed);
+            }
+        } else {
+            lanes[lane].enqueue(std::forward<Args>(args)...);
+        }
+        eventCount.wakeOne();
+    }
+
+    /**
+     * @brief Creates a lane's producer token, for lane queues that have them.
+     * @tparam Args The lane queue's producerToken() arguments.
+     * @param lane The lane, less than Lanes.
+     * @param args Forwarded to the lane's producerToken().
+     * @return The token; pass it to enqueue() with the same lane.
+     */
+    template <typename... Args>
+    auto producerToken(std::size_t lane, Args&&... args) {
+        return lanes[lane].producerToken(std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Process one event from the most urgent lane that has one.
+     * @return true if an event was processed, false otherwise.
+     */
+    bool processOne() { return processNext(); }
+
+    /**
+     * @brief Process one event, advancing the caller's own cursor of
+     * whichever lane is served.
+     * @param cursor The consumer's cursors.
+     * @return true if an event was processed, false otherwise.
+     */
+    bool processOne(Cursor& cursor) { return processNext(cursor); }
+
+    /**
+     * @brief Process events until the queue is empty or a count is reached.
+     * @tparam Cursor Either nothing, to use the shared cursors, or
+     * PriorityCursor.
+     * @param maxEvents The maximum number of events to process.
+     * @param cursor Optionally, the consumer's own cursor.
+     * @return The number of events processed.
+     */
+    template <typename... Cursor>
+        requires(sizeof...(Cursor) <= 1)
+    std::size_t processBatch(std::size_t maxEvents, Cursor&... cursor) {
+        return detail::drainEvents(maxEvents, [&](std::size_t /*allowed*/) {
+            return processOne(cursor...) ? 1 : 0;
+        });
+    }
+
+    /**
+     * @brief Process events until the queue is empty or a budget runs out.
+     * @tparam Cursor Either nothing, to use the shared cursors, or
+     * PriorityCursor.
+     * @param budget The maximum time to spend processing.
+     * @param maxEvents The maximum number of events to process.
+     * @param cursor Optionally, the consumer's own cursor.
+     * @return The number of events processed.
+     */
+    template <typename Rep, typename Period, typename... Cursor>
+        requires(sizeof...(Cursor) <= 1)
+    std::size_t processFor(
+        const std::chrono::duration<Rep, Period>& budget,
+        std::size_t maxEvents = std::numeric_limits<std::size_t>::max(),
+        Cursor&... cursor) {
+        return detail::drainEventsFor(
+            budget, maxEvents, [&](std::size_t /*allowed*/) {
+                return processOne(cursor...) ? 1 : 0;
+            });
+    }
+
+    /**
+     * @brief Approximate number of events waiting in all lanes.
+     * @return The number of pending events.
+     */
+    std::size_t pendingEvents() {
+        std::size_t total = 0;
+        for (auto& lane : lanes) {
+            total += lane.pendingEvents();
+        }
+        return total;
+    }
+
+    /**
+     * @brief Checks whether any lane has pending events.
+     * @return true if at least one event may be waiting to be processed.
+     */
+    bool hasPendingEvents() {
+        for (auto& lane : lanes) {
+            if (lane.hasPendingEvents()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Blocks the calling consumer until there may be events to process.
+     *
+     * Parks on an EventCount, like BasicSpecialEventQueue::waitForEvents().
+     *
+     * @tparam Predicate A callable returning true when the wait should end
+     * regardless of pending events.
+     * @param shouldStop The stop condition. Whoever makes it true must call
+     * notifyAll() afterwards.
+     */
+    template <typename Predicate>
+    void waitForEvents(Predicate&& shouldStop) {
+        eventCount.wait([this] { return hasPendingEvents(); },
+                        std::forward<Predicate>(shouldStop));
+    }
+
+    /**
+     * @brief Wakes every consumer blocked in waitForEvents().
+     */
+    void notifyAll() { eventCount.wakeAll(); }
+
+    /**
+     * @brief Add a new event handler for a specific event type, on every
+     * lane.
+     * @tparam H The type of the handler function.
+     * @param type The event type to associate with the handler.
+     * @param handler The handler function to add.
+     */
+    template <typename H>
+    void appendListener(const key_type& type, const H& handler) {
+        for (auto& lane : lanes) {
+            lane.appendListener(type, handler);
+        }
+    }
+
+    /**
+     * @brief Invokes the handlers of an event type right away, bypassing the
+     * queue.
+     * @tparam T The type of the event.
+     * @param type The event type.
+     * @param event The event passed to each handler.
+     */
+    template <typename T>
+    void dispatch(const key_type& type, const T& event) {
+        lanes[0].dispatch(type, event);
+    }
+};
+
+}  // namespace eventTree::eventHubs
+
+#endif  // PRIORITY_EVENT_QUEUE_H
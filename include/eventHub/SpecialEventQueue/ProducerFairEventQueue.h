@@ -0,0 +1,476 @@
+/**
+ * @file ProducerFairEventQueue.h
+ * @brief An event queue that is fair across producers first, and across event
+ * types second.
+ */
+
+#ifndef PRODUCER_FAIR_EVENT_QUEUE_H
+#define PRODUCER_FAIR_EVENT_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "EventCount.h"
+#include "SlotIndex.h"
+#include "SpecialEventQueue.h"
+
+namespace eventTree::eventHubs {
+
+namespace detail {
+
+/**
+ * @struct ProducerLane
+ * @brief The events of a single producer, kept apart from everyone else's.
+ *
+ * @tparam ProducerId The type used to identify producers.
+ * @tparam Lane The per-producer event queue.
+ */
+template <typename ProducerId, typename Lane>
+struct ProducerLane {
+    /**
+     * @brief Constructs an empty lane for the given producer.
+     * @param producer The producer this lane belongs to.
+     * @param index The position of this lane in round-robin order.
+     */
+    ProducerLane(const ProducerId& producer, std::size_t index)
+        : producer(producer), index(index) {}
+
+    ProducerId producer;  ///< The producer of this lane.
+    std::size_t index;    ///< Position in round-robin order.
+    Lane queue;           ///< Pending events of this producer, by type.
+
+    /** @brief Events enqueued and not yet handled. Drives the ready bit. */
+    std::atomic<std::size_t> pending{0};
+
+    /** @brief Number of registered handlers already added to this lane. */
+    std::atomic<std::size_t> appliedHandlers{0};
+};
+
+}  // namespace detail
+
+/**
+ * @struct ProducerFairCursor
+ * @brief The round-robin positions of a single consumer: one over the
+ * producers, and one over the event types of each producer's lane.
+ *
+ * Producers come and go, so the per-lane positions are added the first time
+ * the consumer visits a lane.
+ */
+struct ProducerFairCursor {
+    DispatchCursor producers;           ///< Position over the producers.
+    std::vector<DispatchCursor> lanes;  ///< Position in each lane, by index.
+
+    /** @brief Where the position in a newly visited lane starts. */
+    std::size_t laneStart = 0;
+
+    /**
+     * @brief The position in a lane, added at laneStart if it is new.
+     * @param index The index of the lane.
+     * @return The consumer's cursor in that lane.
+     */
+    DispatchCursor& lane(std::size_t index) {
+        if (index >= lanes.size()) {
+            lanes.resize(index + 1, DispatchCursor{laneStart});
+        }
+        return lanes[index];
+    }
+};
+
+/**
+ * @class ProducerFairEventQueue
+ * @brief A thread-safe event queue with two-level fair scheduling.
+ *
+ * @tparam ProducerId The type used to identify producers.
+ * @tparam EventType The type used to identify different events.
+ * @tparam HandlerType The type of the event handlers.
+ * @tparam QueueType The type of queue used to store events.
+ *
+ * Every producer gets its own lane, a SpecialEventQueue with its own per-type
+ * queues, so producers never contend with each other on enqueue. Dispatch
+ * goes round robin across the producers with pending events, and within a
+ * producer round robin across its event types. A producer flooding a type
+ * therefore cannot starve another producer emitting the same type.
+ *
+ * Handlers are registered per event type, as with SpecialEventQueue, and
+ * apply to the events of every producer.
+ */
+template <typename ProducerId, typename EventType, typename HandlerType,
+          typename QueueType>
+    requires HashableConcept<ProducerId> &&
+             DefaultConstructible<ProducerId> &&
+             HashableConcept<EventType> && DefaultConstructible<QueueType> &&
+             QueueConcept<QueueType> &&
+             HandlerConcept<HandlerType, QueueType> &&
+             std::copy_constructible<HandlerType>
+class ProducerFairEventQueue {
+   private:
+    using Lane = SpecialEventQueue<EventType, HandlerType, QueueType>;
+    using LaneSlot = detail::ProducerLane<ProducerId, Lane>;
+
+    detail::HashedSlotIndex<ProducerId, LaneSlot> lanes;
+
+    /**
+     * @brief The lane of ProducerId{}. It exists before any handler is
+     * registered, so appendListener() always keeps it up to date.
+     */
+    LaneSlot* defaultLane;
+
+    std::atomic<std::size_t> currentIndex{0};
+    detail::EventCount eventCount;  ///< Parks idle consumers.
+
+    std::mutex registrationMutex;  ///< Guards registrations.
+    std::vector<std::pair<EventType, HandlerType>> registrations;
+    std::atomic<std::size_t> registered{0};  ///< Size of registrations.
+
+    /**
+     * @brief Adds the handlers a lane has not seen yet.
+     *
+     * Must be called with registrationMutex held.
+     *
+     * @param lane The lane to bring up to date.
+     */
+    void applyHandlers(LaneSlot& lane) {
+        auto applied = lane.appliedHandlers.load(std::memory_order_relaxed);
+        for (; applied < registrations.size(); ++applied) {
+            const auto& [type, handler] = registrations[applied];
+            lane.queue.appendListener(type, handler);
+        }
+        lane.appliedHandlers.store(applied, std::memory_order_release);
+    }
+
+    /**
+     * @brief Finds a producer's lane, creating it with every registered
+     * handler the first time.
+     * @param producer The producer.
+     * @return A reference to the producer's lane.
+     */
+    LaneSlot& laneOf(const ProducerId& producer) {
+        return refreshed(lanes.getOrCreate(producer));
+    }
+
+    /**
+     * @brief Adds any handler registered since a lane was last used.
+     * @param lane The lane.
+     * @return The lane.
+     */
+    LaneSlot& refreshed(LaneSlot& lane) {
+        // Pairs with the fence in appendListener(): either it sees this lane,
+        // or this lane sees its registration.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (lane.appliedHandlers.load(std::memory_order_acquire) !=
+            registered.load(std::memory_order_relaxed)) {
+            std::lock_guard<std::mutex> lock(registrationMutex);
+            applyHandlers(lane);
+        }
+        return lane;
+    }
+
+    /**
+     * @brief Clears the ready bit of a lane that ran out of events, like
+     * BasicSpecialEventQueue::markIdle().
+     * @param lane The lane that became empty.
+     */
+    void markIdle(LaneSlot& lane) {
+        lanes.ready().clear(lane.index);
+        if (lane.pending.load() != 0) {
+            lanes.ready().mark(lane.index);
+        }
+    }
+
+    /**
+     * @brief Handles the next event in producer round-robin order.
+     * @param[in,out] position The producer cursor.
+     * @param consumer The consumer's own cursor, whose lane positions pick
+     * the type within a lane; nullptr to use each lane's shared cursor.
+     * @return true if an event was processed.
+     */
+    bool processAt(std::size_t& position, ProducerFairCursor* consumer) {
+        auto laneCount = lanes.size();
+        if (laneCount == 0) {
+            return false;
+        }
+
+        auto start = position % laneCount;
+        for (std::size_t visited = 0; visited < laneCount; ++visited) {
+            auto index = lanes.ready().findFrom(start, laneCount);
+            if (!index) {
+                return false;
+            }
+            // The next call starts with the producer after this one.
+            position = *index + 1;
+
+            auto& lane = lanes[*index];
+            auto processed = consumer != nullptr
+                                 ? lane.queue.processOne(consumer->lane(*index))
+                                 : lane.queue.processOne();
+            if (processed) {
+                if (lane.pending.fetch_sub(1) == 1) {
+                    markIdle(lane);
+                }
+                return true;
+            }
+            if (lane.pending.load() == 0) {
+                markIdle(lane);
+            }
+            start = (*index + 1) % laneCount;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Counts an event enqueued on a lane and wakes a consumer.
+     * @param lane The lane.
+     * @param push Pushes the event into the lane's queue.
+     */
+    template <typename Push>
+    void enqueueOn(LaneSlot& lane, Push&& push) {
+        if (lane.pending.fetch_add(1) == 0) {
+            lanes.ready().mark(lane.index);
+        }
+        std::invoke(std::forward<Push>(push), lane.queue);
+        eventCount.wakeOne();
+    }
+
+   public:
+    using key_type = EventType;        ///< The type used to identify events.
+    using producer_type = ProducerId;  ///< The type used for producers.
+
+    /** @brief The cursors a consumer keeps for this queue. */
+    using Cursor = ProducerFairCursor;
+
+    /**
+     * @class ProducerToken
+     * @brief A producer's lane together with its queue tokens, see
+     * producerToken().
+     */
+    class ProducerToken {
+        friend class ProducerFairEventQueue;
+
+        explicit ProducerToken(LaneSlot& lane)
+            : lane(&lane), token(lane.queue.producerToken()) {}
+
+        LaneSlot* lane;                       ///< The producer's lane.
+        typename Lane::ProducerToken token;  ///< Tokens of its queues.
+    };
+
+    /**
+     * @brief Constructs an empty queue.
+     *
+     * The lane of the default producer, ProducerId{}, always exists and takes
+     * the events enqueued without a producer.
+     */
+    ProducerFairEventQueue()
+        : defaultLane(&lanes.getOrCreate(ProducerId{})) {}
+
+    /**
+     * @brief Enqueue an event of a specific type on behalf of a producer.
+     * @tparam T The type of the event to enqueue.
+     * @param producer The producer emitting the event.
+     * @param type The event type.
+     * @param event The event to enqueue.
+     */
+    template <typename T>
+    void enqueue(const ProducerId& producer, const EventType& type,
+                 T&& event) {
+        enqueueOn(laneOf(producer), [&](Lane& queue) {
+            queue.enqueue(type, std::forward<T>(event));
+        });
+    }
+
+    /**
+     * @brief Creates a token for a producer thread.
+     *
+     * The token keeps the producer's lane, so enqueueing through it skips
+     * the lane lookup, and the lane's queue tokens. It must only be used by
+     * one thread at a time.
+     *
+     * @param producer The producer.
+     * @return A new producer token.
+     */
+    ProducerToken producerToken(const ProducerId& producer) {
+        return ProducerToken(laneOf(producer));
+    }
+
+    /**
+     * @brief Enqueue an event through a producer's token.
+     * @tparam T The type of the event to enqueue.
+     * @param producer The producer's token, made by this queue.
+     * @param type The event type.
+     * @param event The event to enqueue.
+     */
+    template <typename T>
+    void enqueue(ProducerToken& producer, const EventType& type, T&& event) {
+        enqueueOn(refreshed(*producer.lane), [&](Lane& queue) {
+            queue.enqueue(producer.token, type, std::forward<T>(event));
+        });
+    }
+
+    /**
+     * @brief Enqueue an event of a specific type on the default producer.
+     * @tparam T The type of the event to enqueue.
+     * @param type The event type.
+     * @param event The event to enqueue.
+     */
+    template <typename T>
+    void enqueue(const EventType& type, T&& event) {
+        enqueueOn(*defaultLane, [&](Lane& queue) {
+            queue.enqueue(type, std::forward<T>(event));
+        });
+    }
+
+    /**
+     * @brief Process one event, going round robin over the producers with a
+     * cursor shared by every consumer.
+     * @return true if an event was processed, false otherwise.
+     */
+    bool processOne() {
+        auto position = currentIndex.load(std::memory_order_relaxed);
+        auto processed = processAt(position, nullptr);
+        currentIndex.store(position, std::memory_order_relaxed);
+        return processed;
+    }
+
+    /**
+     * @brief Process one event, advancing the caller's own cursors over the
+     * producers and within the chosen producer's lane.
+     * @param cursor The consumer's cursors.
+     * @return true if an event was processed, false otherwise.
+     */
+    bool processOne(Cursor& cursor) {
+        return processAt(cursor.producers.position, &cursor);
+    }
+
+    /**
+     * @brief Process events until the queue is empty or a count is reached.
+     * @tparam Cursor Either nothing, to use the shared cursors, or
+     * ProducerFairCursor.
+     * @param maxEvents The maximum number of events to process.
+     * @param cursor Optionally, the consumer's own cursor.
+     * @return The number of events processed.
+     */
+    template <typename... Cursor>
+        requires(sizeof...(Cursor) <= 1)
+    std::size_t processBatch(std::size_t maxEvents, Cursor&... cursor) {
+        return detail::drainEvents(maxEvents, [&](std::size_t /*allowed*/) {
+            return processOne(cursor...) ? 1 : 0;
+        });
+    }
+
+    /**
+     * @brief Process events until the queue is empty or a budget runs out.
+     * @tparam Cursor Either nothing, to use the shared cursors, or
+     * ProducerFairCursor.
+     * @param budget The maximum time to spend processing.
+     * @param maxEvents The maximum number of events to process.
+     * @param cursor Optionally, the consumer's own cursor.
+     * @return The number of events processed.
+     */
+    template <typename Rep, typename Period, typename... Cursor>
+        requires(sizeof...(Cursor) <= 1)
+    std::size_t processFor(
+        const std::chrono::duration<Rep, Period>& budget,
+        std::size_t maxEvents = std::numeric_limits<std::size_t>::max(),
+        Cursor&... cursor) {
+        return detail::drainEventsFor(
+            budget, maxEvents, [&](std::size_t /*allowed*/) {
+                return processOne(cursor...) ? 1 : 0;
+            });
+    }
+
+    /**
+     * @brief Approximate number of events waiting to be processed, including
+     * events whose handlers are running.
+     * @return The number of pending events.
+     */
+    std::size_t pendingEvents() {
+        std::size_t total = 0;
+        auto laneCount = lanes.size();
+        for (std::size_t index = 0; index < laneCount; ++index) {
+            total += lanes[index].pending.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Checks whether any producer has events waiting for a consumer.
+     *
+     * Looks at the lanes' own ready bits, which are cleared as soon as an
+     * event is taken, so an event being handled does not keep other
+     * consumers awake.
+     *
+     * @return true if at least one event may be waiting to be processed.
+     */
+    bool hasPendingEvents() {
+        auto laneCount = lanes.size();
+        for (std::size_t index = 0; index < laneCount; ++index) {
+            if (lanes[index].queue.hasPendingEvents()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Blocks the calling consumer until there may be events to process.
+     *
+     * Parks on an EventCount, like BasicSpecialEventQueue::waitForEvents().
+     *
+     * @tparam Predicate A callable returning true when the wait should end
+     * regardless of pending events.
+     * @param shouldStop The stop condition. Whoever makes it true must call
+     * notifyAll() afterwards.
+     */
+    template <typename Predicate>
+    void waitForEvents(Predicate&& shouldStop) {
+        eventCount.wait([this] { return hasPendingEvents(); },
+                        std::forward<Predicate>(shouldStop));
+    }
+
+    /**
+     * @brief Wakes every consumer blocked in waitForEvents().
+     */
+    void notifyAll() { eventCount.wakeAll(); }
+
+    /**
+     * @brief Add a new event handler for a specific event type, for the
+     * events of every producer.
+     * @tparam H The type of the handler function.
+     * @param type The event type to associate with the handler.
+     * @param handler The handler function to add.
+     */
+    template <typename H>
+    void appendListener(const EventType& type, H&& handler) {
+        std::lock_guard<std::mutex> lock(registrationMutex);
+        registrations.emplace_back(type, std::forward<H>(handler));
+        registered.store(registrations.size(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto laneCount = lanes.size();
+        for (std::size_t index = 0; index < laneCount; ++index) {
+            applyHandlers(lanes[index]);
+        }
+    }
+
+    /**
+     * @brief Invokes the handlers of an event type right away, bypassing the
+     * queue.
+     * @tparam T The type of the event.
+     * @param type The event type.
+     * @param event The event passed to each handler.
+     */
+    template <typename T>
+    void dispatch(const EventType& type, const T& event) {
+        defaultLane->queue.dispatch(type, event);
+    }
+};
+
+}  // namespace eventTree::eventHubs
+
+#endif  // PRODUCER_FAIR_EVENT_QUEUE_H
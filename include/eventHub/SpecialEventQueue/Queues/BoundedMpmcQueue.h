@@ -0,0 +1,149 @@
+#ifndef BOUNDED_MPMC_QUEUE_H
+#define BOUNDED_MPMC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <utility>
+
+namespace eventTree::queues {
+
+/**
+ * @class BoundedMpmcQueue
+ * @brief A bounded multi-producer multi-consumer queue over a fixed array.
+ *
+ * @tparam T The type of elements stored in the queue.
+ * @tparam Capacity The number of elements the queue holds, a power of two.
+ *
+ * Every cell carries a sequence number that tells producers and consumers
+ * whether it is free for the lap they are on (Dmitry Vyukov's design). A push
+ * or pop is one compare-and-swap on the shared position plus one store to the
+ * cell, and the memory used never grows past Capacity elements.
+ */
+template <typename T, std::size_t Capacity = 1024>  // NOLINT
+    requires(Capacity >= 2 && std::has_single_bit(Capacity))
+class BoundedMpmcQueue {
+   private:
+    static constexpr std::size_t mask = Capacity - 1;
+    static constexpr std::size_t cacheLineSize = 64;
+
+    /**
+     * @struct Cell
+     * @brief An element and the lap it is ready for.
+     */
+    struct Cell {
+        std::atomic<std::size_t> sequence;  ///< Position it is free at.
+        T value;                            ///< The stored element.
+    };
+
+    std::array<Cell, Capacity> cells;
+
+    /** @brief Next position to push to. */
+    alignas(cacheLineSize) std::atomic<std::size_t> enqueuePosition{0};
+
+    /** @brief Next position to pop from. */
+    alignas(cacheLineSize) std::atomic<std::size_t> dequeuePosition{0};
+
+   public:
+    using value_type = T;  ///< The type of elements stored in the queue.
+
+    /** @brief The number of elements the queue holds. */
+    static constexpr std::size_t capacity = Capacity;
+
+    /**
+     * @brief Constructs an empty queue.
+     */
+    BoundedMpmcQueue() {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Attempts to push an item into the queue.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param item The item to be pushed into the queue. It is left untouched
+     * if the queue is full.
+     * @return true if the item was pushed, false if the queue was full.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, T>
+    bool try_push(U&& item) {
+        auto position = enqueuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = cells[position & mask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto lag = static_cast<std::intptr_t>(sequence) -
+                       static_cast<std::intptr_t>(position);
+            if (lag == 0) {
+                if (enqueuePosition.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::forward<U>(item);
+                    cell.sequence.store(position + 1,
+                                        std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Pushes an item into the queue, waiting for consumers while the
+     * queue is full.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param item The item to be pushed into the queue.
+     *
+     * @note This function is enabled only if U is convertible to T.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, T>
+    void push(U&& item) {
+        // try_push() leaves the item alone when it fails.
+        while (!try_push(std::forward<U>(item))) {  // NOLINT
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Attempts to pop an item from the queue.
+     *
+     * @param[out] item The variable to store the popped item.
+     * @return true if an item was successfully popped, false if the queue was
+     * empty.
+     */
+    bool pop(T& item) {
+        auto position = dequeuePosition.load(std::memory_order_relaxed);
+        while (true) {
+            auto& cell = cells[position & mask];
+            auto sequence = cell.sequence.load(std::memory_order_acquire);
+            auto lag = static_cast<std::intptr_t>(sequence) -
+                       static_cast<std::intptr_t>(position + 1);
+            if (lag == 0) {
+                if (dequeuePosition.compare_exchange_weak(
+                        position, position + 1, std::memory_order_relaxed)) {
+                    item = std::move(cell.value);
+                    cell.sequence.store(position + Capacity,
+                                        std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = dequeuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+}  // namespace eventTree::queues
+#endif  // BOUNDED_MPMC_QUEUE_H
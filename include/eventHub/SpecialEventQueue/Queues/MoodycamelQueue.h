@@ -4,6 +4,7 @@
 #include <concurrentqueue.h>
 
 #include <concepts>
+#include <cstddef>
 
 namespace eventTree::queues {
 
@@ -26,6 +27,24 @@ class MoodycamelQueue {
 
    public:
     using value_type = T;  ///< The type of elements stored in the queue.
+    using producer_token = moodycamel::ProducerToken;  ///< See push().
+    using consumer_token = moodycamel::ConsumerToken;  ///< See pop().
+
+    /**
+     * @brief Creates a token for a single producer thread.
+     *
+     * Items pushed through the token go to the producer's own sub-queue,
+     * without the thread-local lookup of the implicit producer path.
+     *
+     * @return A new producer token for this queue.
+     */
+    producer_token producerToken() { return producer_token(queue); }
+
+    /**
+     * @brief Creates a token for a single consumer thread.
+     * @return A new consumer token for this queue.
+     */
+    consumer_token consumerToken() { return consumer_token(queue); }
 
     /**
      * @brief Pushes an item into the queue.
@@ -55,6 +74,83 @@ class MoodycamelQueue {
      * and leaves the @p item parameter unchanged.
      */
     bool pop(T& item) { return queue.try_dequeue(item); }
+
+    /**
+     * @brief Pushes an item through a producer token.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param token A token made by this queue, used by one thread at a time.
+     * @param item The item to be pushed into the queue.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, T>
+    void push(producer_token& token, U&& item) {
+        queue.enqueue(token, std::forward<U>(item));
+    }
+
+    /**
+     * @brief Attempts to pop an item through a consumer token.
+     *
+     * @param token A token made by this queue, used by one thread at a time.
+     * @param[out] item The variable to store the popped item.
+     * @return true if an item was successfully popped, false if the queue was
+     * empty.
+     */
+    bool pop(consumer_token& token, T& item) {
+        return queue.try_dequeue(token, item);
+    }
+
+    /**
+     * @brief Pushes several items into the queue in one operation.
+     *
+     * @tparam It An input iterator whose elements convert to T.
+     * @param first The first item to push.
+     * @param count The number of items to push.
+     */
+    template <typename It>
+    void push_bulk(It first, std::size_t count) {
+        queue.enqueue_bulk(first, count);
+    }
+
+    /**
+     * @brief Pops up to a number of items from the queue in one operation.
+     *
+     * @tparam It An output iterator accepting T.
+     * @param out Where the popped items are written.
+     * @param maxCount The maximum number of items to pop.
+     * @return The number of items popped.
+     */
+    template <typename It>
+    std::size_t pop_bulk(It out, std::size_t maxCount) {
+        return queue.try_dequeue_bulk(out, maxCount);
+    }
+
+    /**
+     * @brief Pushes several items through a producer token.
+     *
+     * @tparam It An input iterator whose elements convert to T.
+     * @param token A token made by this queue, used by one thread at a time.
+     * @param first The first item to push.
+     * @param count The number of items to push.
+     */
+    template <typename It>
+    void push_bulk(producer_token& token, It first, std::size_t count) {
+        queue.enqueue_bulk(token, first, count);
+    }
+
+    /**
+     * @brief Pops up to a number of items through a consumer token.
+     *
+     * @tparam It An output iterator accepting T.
+     * @param token A token made by this queue, used by one thread at a time.
+     * @param out Where the popped items are written.
+     * @param maxCount The maximum number of items to pop.
+     * @return The number of items popped.
+     */
+    template <typename It>
+    std::size_t pop_bulk(consumer_token& token, It out, std::size_t maxCount) {
+        return queue.try_dequeue_bulk(token, out, maxCount);
+    }
 };
 }  // namespace eventTree::queues
 #endif  // MOODYCAMEL_QUEUE_H
\ No newline at end of file
@@ -0,0 +1,211 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <utility>
+
+namespace eventTree::queues {
+
+/**
+ * @class MpscQueue
+ * @brief An unbounded multi-producer single-consumer linked queue.
+ *
+ * @tparam T The type of elements stored in the queue.
+ *
+ * Dmitry Vyukov's node-based design: a push links its node with a single
+ * atomic exchange, and a pop only loads and stores, without any atomic
+ * read-modify-write. A pop may briefly find the queue empty while a producer
+ * is between its exchange and the link to its node.
+ *
+ * Nodes are recycled instead of freed. The consumer collects popped nodes
+ * privately and hands them back in batches through a single pointer. A
+ * producer that runs out of nodes takes the whole batch into a cache of its
+ * own thread with one atomic exchange, so producers share nothing but that
+ * exchange, once per batch, and a queue in steady state allocates nothing.
+ * The cache is shared by every MpscQueue<T> the thread pushes to, and frees
+ * its nodes when the thread exits.
+ *
+ * Any number of threads may push, but only one thread may pop at a time. In a
+ * SpecialEventQueue this fits a queue with a single dispatch thread.
+ */
+template <typename T>
+class MpscQueue {
+   private:
+    static constexpr std::size_t cacheLineSize = 64;
+
+    /** @brief Popped nodes the consumer collects before handing them back. */
+    static constexpr std::size_t recycleBatch = 64;
+
+    /**
+     * @struct Node
+     * @brief A queued element, or a free node.
+     */
+    struct Node {
+        std::atomic<Node*> next{nullptr};  ///< The next node in its list.
+        T value{};                         ///< The element.
+    };
+
+    /** @brief Most recently pushed node; producers exchange it. */
+    alignas(cacheLineSize) std::atomic<Node*> back;
+
+    /** @brief Popped nodes waiting for a producer to take them back. */
+    alignas(cacheLineSize) std::atomic<Node*> returned{nullptr};
+
+    /** @brief Nodes allocated by pushes to this queue. */
+    alignas(cacheLineSize) std::atomic<std::size_t> allocated{0};
+
+    /** @brief The last popped node, whose next is the front; consumer only. */
+    alignas(cacheLineSize) Node* front;
+    Node* recycled = nullptr;       ///< Popped nodes not handed back yet.
+    std::size_t recycledCount = 0;  ///< Length of recycled.
+
+    /**
+     * @struct NodeCache
+     * @brief The free nodes of one producer thread.
+     */
+    struct NodeCache {
+        Node* head = nullptr;  ///< The first free node.
+
+        NodeCache() = default;
+        ~NodeCache() { freeList(head); }
+
+        // Special constructors to comply with "rule of 5"
+        NodeCache(const NodeCache&) = delete;
+        NodeCache& operator=(const NodeCache&) = delete;
+        NodeCache(NodeCache&&) = delete;
+        NodeCache& operator=(NodeCache&&) = delete;
+    };
+
+    static NodeCache& nodeCache() {
+        thread_local NodeCache cache;
+        return cache;
+    }
+
+    /**
+     * @brief Takes a free node from the calling thread's cache, refilling it
+     * with the consumer's last batch, and allocates only if both are empty.
+     * @return A node that is not in any list.
+     */
+    Node* acquireNode() {
+        auto& cache = nodeCache();
+        if (cache.head == nullptr) {
+            cache.head = returned.exchange(nullptr, std::memory_order_acquire);
+            if (cache.head == nullptr) {
+                allocated.fetch_add(1, std::memory_order_relaxed);
+                return new Node;  // NOLINT
+            }
+        }
+        auto* node = cache.head;
+        cache.head = node->next.load(std::memory_order_relaxed);
+        node->next.store(nullptr, std::memory_order_relaxed);
+        return node;
+    }
+
+    /**
+     * @brief Keeps a popped node for reuse, handing a batch back to the
+     * producers once they have taken the previous one.
+     * @param node The node that is no longer in the queue.
+     */
+    void recycleNode(Node* node) {
+        node->next.store(recycled, std::memory_order_relaxed);
+        recycled = node;
+        if (++recycledCount >= recycleBatch &&
+            returned.load(std::memory_order_relaxed) == nullptr) {
+            // Only producers reset returned, so a plain store cannot lose a
+            // batch.
+            returned.store(recycled, std::memory_order_release);
+            recycled = nullptr;
+            recycledCount = 0;
+        }
+    }
+
+    /**
+     * @brief Frees a list of nodes.
+     * @param node The first node.
+     */
+    static void freeList(Node* node) {
+        while (node != nullptr) {
+            auto* next = node->next.load(std::memory_order_relaxed);
+            delete node;  // NOLINT
+            node = next;
+        }
+    }
+
+   public:
+    using value_type = T;  ///< The type of elements stored in the queue.
+
+    /** @brief Only one thread may pop. */
+    static constexpr bool single_consumer() { return true; }
+
+    /**
+     * @brief Constructs an empty queue.
+     */
+    MpscQueue() : back(new Node), front(back.load()) {}  // NOLINT
+
+    /**
+     * @brief Destructor. Frees every node.
+     */
+    ~MpscQueue() {
+        freeList(front);
+        freeList(recycled);
+        freeList(returned.load());
+    }
+
+    // Special constructors to comply with "rule of 5"
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    MpscQueue(MpscQueue&&) = delete;
+    MpscQueue& operator=(MpscQueue&&) = delete;
+
+    /**
+     * @brief Pushes an item into the queue.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param item The item to be pushed into the queue.
+     *
+     * This function is thread-safe and uses perfect forwarding to
+     * efficiently move or copy the item into the queue.
+     *
+     * @note This function is enabled only if U is convertible to T.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, T>
+    void push(U&& item) {
+        auto* node = acquireNode();
+        node->value = std::forward<U>(item);
+        auto* previous = back.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * @brief The number of nodes pushes to this queue had to allocate, i.e.
+     * when neither their thread's cache nor the consumer had one to spare.
+     * @return The number of allocated nodes.
+     */
+    [[nodiscard]] std::size_t allocatedNodes() const {
+        return allocated.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Attempts to pop an item from the queue. Single consumer only.
+     *
+     * @param[out] item The variable to store the popped item.
+     * @return true if an item was successfully popped, false if the queue was
+     * empty.
+     */
+    bool pop(T& item) {
+        auto* next = front->next.load(std::memory_order_acquire);
+        if (next == nullptr) {
+            return false;
+        }
+        item = std::move(next->value);
+        recycleNode(front);
+        front = next;
+        return true;
+    }
+};
+
+}  // namespace eventTree::queues
+#endif  // MPSC_QUEUE_H
@@ -2,6 +2,7 @@
 #define NAIVE_QUEUE_H
 
 #include <concepts>
+#include <cstddef>
 #include <mutex>
 #include <queue>
 
@@ -62,6 +63,40 @@ class NaiveQueue {
         queue.pop();
         return true;
     }
+
+    /**
+     * @brief Pushes several items into the queue under a single lock.
+     *
+     * @tparam It An input iterator whose elements convert to T.
+     * @param first The first item to push.
+     * @param count The number of items to push.
+     */
+    template <typename It>
+    void push_bulk(It first, std::size_t count) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (; count != 0; --count, ++first) {
+            queue.push(*first);
+        }
+    }
+
+    /**
+     * @brief Pops up to a number of items from the queue under a single lock.
+     *
+     * @tparam It An output iterator accepting T.
+     * @param out Where the popped items are written.
+     * @param maxCount The maximum number of items to pop.
+     * @return The number of items popped.
+     */
+    template <typename It>
+    std::size_t pop_bulk(It out, std::size_t maxCount) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t count = 0;
+        for (; count < maxCount && !queue.empty(); ++count, ++out) {
+            *out = std::move(queue.front());
+            queue.pop();
+        }
+        return count;
+    }
 };
 
 }  // namespace eventTree::queues
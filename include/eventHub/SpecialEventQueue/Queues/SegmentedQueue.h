@@ -0,0 +1,438 @@
+#ifndef SEGMENTED_QUEUE_H
+#define SEGMENTED_QUEUE_H
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace eventTree::queues {
+
+/**
+ * @class SegmentedQueue
+ * @brief A thread-safe unbounded queue that gives memory back after bursts.
+ *
+ * @tparam T The type of elements stored in the queue.
+ * @tparam SegmentSize The least number of elements in one segment.
+ * @tparam MaxPooledSegments The number of drained segments kept for reuse.
+ *
+ * Elements live in a linked list of fixed-size segments. Each segment is
+ * rounded up to whole pages and filled with as many elements as fit, so
+ * segmentSize is usually larger than SegmentSize. A segment that has been
+ * fully drained goes to a pool of spare segments for the next burst; once
+ * the pool holds MaxPooledSegments, further drained segments are freed.
+ * After a burst the queue therefore keeps at most one live segment plus the
+ * pool, however large the burst was. A queue whose bursts regularly span more
+ * segments can raise the mark to avoid mapping them again every time.
+ *
+ * On Linux segments are mapped and unmapped directly, so the pages of a freed
+ * segment leave the resident set when it is unmapped instead of waiting in
+ * the allocator; segmentBytes is exactly what a segment maps. A push that
+ * runs out of segments maps all it needs, plus a full pool for the pushes
+ * after it, with one call. Freed segments are collected until unmapBatch of
+ * them are waiting or the queue runs empty, and each run of them that is
+ * adjacent in memory, such as the segments of one mapping, is then unmapped
+ * with one call.
+ *
+ * Like NaiveQueue, every operation takes a mutex, but segments are only
+ * mapped and unmapped outside it: a push that needs new segments maps them
+ * before taking the lock, and a pop unmaps a finished batch after releasing
+ * it.
+ */
+template <typename T, std::size_t SegmentSize = 256,  // NOLINT
+          std::size_t MaxPooledSegments = 4>           // NOLINT
+    requires(SegmentSize > 0)
+class SegmentedQueue {
+   private:
+    /** @brief Segments are rounded up to a multiple of this. */
+    static constexpr std::size_t pageSize = 4096;
+
+    /** @brief The bytes of a segment besides its elements, with padding. */
+    static constexpr std::size_t headerBytes =
+        2 * sizeof(std::size_t) + sizeof(void*) +
+        2 * (alignof(T) > alignof(void*) ? alignof(T) : alignof(void*));
+
+    /** @brief The bytes of one segment, a whole number of pages. */
+    static constexpr std::size_t pageBytes =
+        (SegmentSize * sizeof(T) + headerBytes + pageSize - 1) / pageSize *
+        pageSize;
+
+    /** @brief The elements that fit into pageBytes. */
+    static constexpr std::size_t capacity =
+        (pageBytes - headerBytes) / sizeof(T);
+
+    /**
+     * @struct Segment
+     * @brief A block of elements; items in [head, tail) are queued.
+     */
+    struct Segment {
+        std::array<T, capacity> items{};  ///< The element storage.
+        std::size_t head = 0;             ///< Next element to pop.
+        std::size_t tail = 0;             ///< Next element to push.
+        Segment* next = nullptr;          ///< The following segment.
+    };
+    static_assert(sizeof(Segment) <= pageBytes);
+
+    /**
+     * @struct SegmentList
+     * @brief Segments that belong to no queue yet or anymore, freed with the
+     * list. Declared before the lock, a list is freed after it is released.
+     */
+    struct SegmentList {
+        Segment* head = nullptr;  ///< The first segment, linked through next.
+
+        SegmentList() = default;
+        ~SegmentList() { freeList(head); }
+
+        // Special constructors to comply with "rule of 5"
+        SegmentList(const SegmentList&) = delete;
+        SegmentList& operator=(const SegmentList&) = delete;
+        SegmentList(SegmentList&&) = delete;
+        SegmentList& operator=(SegmentList&&) = delete;
+
+        /**
+         * @brief Adds a segment to the front of the list.
+         * @param segment The segment, which must not be in any list.
+         */
+        void push(Segment* segment) {
+            segment->next = head;
+            head = segment;
+        }
+
+        /**
+         * @brief Removes the first segment.
+         * @return The segment, or nullptr if the list is empty.
+         */
+        Segment* pop() {
+            Segment* segment = head;
+            if (segment != nullptr) {
+                head = segment->next;
+                segment->next = nullptr;
+            }
+            return segment;
+        }
+    };
+
+    Segment* front = nullptr;       ///< The segment popped from.
+    Segment* back = nullptr;        ///< The segment pushed to.
+    Segment* pool = nullptr;        ///< Spare segments, linked through next.
+    std::size_t pooled = 0;         ///< The number of segments in pool.
+    std::size_t live = 0;           ///< The segments holding elements.
+    SegmentList retiring;           ///< Freed segments waiting to be unmapped.
+    std::size_t retiringCount = 0;  ///< The number of segments in retiring.
+    mutable std::mutex mutex;
+
+    /**
+     * @brief Allocates and constructs empty segments. On Linux they share
+     * one mapping.
+     * @param count The number of segments.
+     * @param[out] into Receives the segments.
+     */
+    static void allocateSegments(std::size_t count, SegmentList& into) {
+#if defined(__linux__)
+        void* memory = mmap(nullptr, count * pageBytes, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {  // NOLINT
+            throw std::bad_alloc();
+        }
+        auto* bytes = static_cast<std::byte*>(memory);
+        for (std::size_t i = 0; i < count; ++i) {
+            try {
+                into.push(new (bytes + i * pageBytes) Segment);
+            } catch (...) {
+                // The segments constructed so far are unmapped with the list.
+                munmap(bytes + i * pageBytes, (count - i) * pageBytes);
+                throw;
+            }
+        }
+#else
+        for (; count != 0; --count) {
+            into.push(new Segment);  // NOLINT
+        }
+#endif
+    }
+
+    /**
+     * @brief The number of segments to map before appending items.
+     * @param count The number of items to append.
+     * @return The segments needed beyond the free room and the pool.
+     */
+    std::size_t missingSegments(std::size_t count) const {
+        std::size_t room = back == nullptr ? 0 : capacity - back->tail;
+        if (count <= room) {
+            return 0;
+        }
+        std::size_t needed = (count - room + capacity - 1) / capacity;
+        return needed > pooled ? needed - pooled : 0;
+    }
+
+    /**
+     * @brief Appends an item, starting a new segment if the last one is full.
+     * @param item The item to append.
+     * @param spares Segments mapped for this push, used once the pool is
+     * empty. Only if they run out as well is a segment mapped under the lock.
+     */
+    template <typename U>
+    void append(U&& item, SegmentList& spares) {
+        if (back == nullptr || back->tail == capacity) {
+            Segment* segment = pool;
+            if (segment != nullptr) {
+                pool = segment->next;
+                segment->next = nullptr;
+                pooled--;
+            } else if ((segment = spares.pop()) == nullptr) {
+                allocateSegments(1, spares);
+                segment = spares.pop();
+            }
+            if (back == nullptr) {
+                front = segment;
+            } else {
+                back->next = segment;
+            }
+            back = segment;
+            live++;
+        }
+        back->items[back->tail++] = std::forward<U>(item);
+    }
+
+    /**
+     * @brief Removes the front item.
+     * @param[out] item The variable to store the item.
+     * @return true if an item was removed, false if the queue was empty.
+     */
+    bool take(T& item) {
+        if (front == nullptr || front->head == front->tail) {
+            return false;
+        }
+        item = std::move(front->items[front->head++]);
+        if (front->head == front->tail) {
+            Segment* segment = front;
+            front = segment->next;
+            if (front == nullptr) {
+                back = nullptr;
+            }
+            live--;
+            recycle(segment);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Returns an unused segment to the pool, or queues it to be freed
+     * if the pool is full.
+     * @param segment The segment, which must not be in any list.
+     */
+    void recycle(Segment* segment) {
+        if (pooled < maxPooledSegments) {
+            segment->head = 0;
+            segment->tail = 0;
+            segment->next = pool;
+            pool = segment;
+            pooled++;
+        } else {
+            retiring.push(segment);
+            retiringCount++;
+        }
+    }
+
+    /**
+     * @brief Hands the segments waiting to be freed out once there are
+     * unmapBatch of them or the queue is empty.
+     * @param retired Receives the segments, to free them after unlocking.
+     */
+    void release(SegmentList& retired) {
+        if (retiringCount < unmapBatch && front != nullptr) {
+            return;
+        }
+        while (Segment* segment = retiring.pop()) {
+            retired.push(segment);
+        }
+        retiringCount = 0;
+    }
+
+    /**
+     * @brief Appends items, mapping the segments they need before locking.
+     * The same mapping refills the pool, which the items have emptied.
+     * @param count The number of items appendAll() appends.
+     * @param appendAll Called with the spare segments to append the items
+     * under the lock.
+     */
+    template <typename AppendAll>
+    void insert(std::size_t count, AppendAll&& appendAll) {
+        SegmentList spares;
+        SegmentList retired;
+        std::unique_lock<std::mutex> lock(mutex);
+        if (std::size_t missing = missingSegments(count); missing != 0) {
+            lock.unlock();
+            allocateSegments(missing + maxPooledSegments, spares);
+            lock.lock();
+        }
+        appendAll(spares);
+        while (Segment* spare = spares.pop()) {
+            recycle(spare);
+        }
+        release(retired);
+    }
+
+    /**
+     * @brief Destroys a list of segments and gives their memory back. On
+     * Linux, each run of segments adjacent in memory is unmapped at once.
+     * @param segment The first segment.
+     */
+    static void freeList(Segment* segment) {
+#if defined(__linux__)
+        std::byte* run = nullptr;  // [run, run + runBytes) is still mapped.
+        std::size_t runBytes = 0;
+        while (segment != nullptr) {
+            auto* next = segment->next;
+            segment->~Segment();
+            auto* bytes = reinterpret_cast<std::byte*>(segment);
+            if (run != nullptr && bytes == run + runBytes) {
+                runBytes += pageBytes;
+            } else if (run != nullptr && bytes + pageBytes == run) {
+                run = bytes;
+                runBytes += pageBytes;
+            } else {
+                if (run != nullptr) {
+                    munmap(run, runBytes);
+                }
+                run = bytes;
+                runBytes = pageBytes;
+            }
+            segment = next;
+        }
+        if (run != nullptr) {
+            munmap(run, runBytes);
+        }
+#else
+        while (segment != nullptr) {
+            auto* next = segment->next;
+            delete segment;  // NOLINT
+            segment = next;
+        }
+#endif
+    }
+
+   public:
+    using value_type = T;  ///< The type of elements stored in the queue.
+
+    /** @brief The number of elements in one segment, at least SegmentSize. */
+    static constexpr std::size_t segmentSize = capacity;
+
+    /** @brief The bytes one segment maps, a multiple of the page size. */
+    static constexpr std::size_t segmentBytes = pageBytes;
+
+    /** @brief Freed segments collected before they are unmapped together. */
+    static constexpr std::size_t unmapBatch = 16;
+
+    /** @brief Drained segments kept for reuse; the rest are freed. */
+    static constexpr std::size_t maxPooledSegments = MaxPooledSegments;
+
+    /**
+     * @brief Constructs an empty queue that owns no segments.
+     */
+    SegmentedQueue() = default;
+
+    /**
+     * @brief Destructor. Frees every segment.
+     */
+    ~SegmentedQueue() {
+        freeList(front);
+        freeList(pool);
+    }
+
+    // Special constructors to comply with "rule of 5"
+    SegmentedQueue(const SegmentedQueue&) = delete;
+    SegmentedQueue& operator=(const SegmentedQueue&) = delete;
+    SegmentedQueue(SegmentedQueue&&) = delete;
+    SegmentedQueue& operator=(SegmentedQueue&&) = delete;
+
+    /**
+     * @brief Pushes an item into the queue.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param item The item to be pushed into the queue.
+     *
+     * This function is thread-safe and uses perfect forwarding to
+     * efficiently move or copy the item into the queue.
+     *
+     * @note This function is enabled only if U is convertible to T.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, T>
+    void push(U&& item) {
+        insert(1, [&](SegmentList& spares) {
+            append(std::forward<U>(item), spares);
+        });
+    }
+
+    /**
+     * @brief Attempts to pop an item from the queue.
+     *
+     * @param[out] item The variable to store the popped item.
+     * @return true if an item was successfully popped, false if the queue was
+     * empty.
+     */
+    bool pop(T& item) {
+        SegmentList retired;
+        std::lock_guard<std::mutex> lock(mutex);
+        bool taken = take(item);
+        release(retired);
+        return taken;
+    }
+
+    /**
+     * @brief Pushes several items into the queue under a single lock.
+     *
+     * @tparam It An input iterator whose elements convert to T.
+     * @param first The first item to push.
+     * @param count The number of items to push.
+     */
+    template <typename It>
+    void push_bulk(It first, std::size_t count) {
+        insert(count, [&](SegmentList& spares) {
+            for (; count != 0; --count, ++first) {
+                append(*first, spares);
+            }
+        });
+    }
+
+    /**
+     * @brief Pops up to a number of items from the queue under a single lock.
+     *
+     * @tparam It An output iterator accepting T.
+     * @param out Where the popped items are written.
+     * @param maxCount The maximum number of items to pop.
+     * @return The number of items popped.
+     */
+    template <typename It>
+    std::size_t pop_bulk(It out, std::size_t maxCount) {
+        SegmentList retired;
+        std::lock_guard<std::mutex> lock(mutex);
+        std::size_t count = 0;
+        for (T item; count < maxCount && take(item); ++count, ++out) {
+            *out = std::move(item);
+        }
+        release(retired);
+        return count;
+    }
+
+    /**
+     * @brief The number of segments the queue currently owns, queued, pooled
+     * or waiting to be unmapped.
+     * @return The segment count.
+     */
+    std::size_t allocatedSegments() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return live + pooled + retiringCount;
+    }
+};
+
+}  // namespace eventTree::queues
+#endif  // SEGMENTED_QUEUE_H
@@ -0,0 +1,161 @@
+#ifndef SPSC_RING_QUEUE_H
+#define SPSC_RING_QUEUE_H
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+namespace eventTree::queues {
+
+/**
+ * @class SpscRingQueue
+ * @brief A bounded, wait-free single-producer single-consumer ring buffer.
+ *
+ * @tparam T The type of elements stored in the queue.
+ * @tparam Capacity The number of elements the ring holds, a power of two.
+ *
+ * The head and tail indices live on cache lines of their own. Each side also
+ * keeps the last value it read of the other side's index, so it only touches
+ * the other side's cache line when the ring looks full or empty.
+ *
+ * Exactly one thread may push and exactly one thread may pop at a time. In a
+ * SpecialEventQueue this fits a type with a single producer thread dispatched
+ * by a single consumer thread.
+ */
+template <typename T, std::size_t Capacity = 1024>  // NOLINT
+    requires(Capacity >= 2 && std::has_single_bit(Capacity))
+class SpscRingQueue {
+   private:
+    static constexpr std::size_t mask = Capacity - 1;
+    static constexpr std::size_t cacheLineSize = 64;
+
+    /** @brief Next position to write; written by the producer only. */
+    alignas(cacheLineSize) std::atomic<std::size_t> tail{0};
+    std::size_t cachedHead = 0;  ///< The producer's last read of head.
+
+    /** @brief Next position to read; written by the consumer only. */
+    alignas(cacheLineSize) std::atomic<std::size_t> head{0};
+    std::size_t cachedTail = 0;  ///< The consumer's last read of tail.
+
+    alignas(cacheLineSize) std::array<T, Capacity> buffer{};
+
+   public:
+    using value_type = T;  ///< The type of elements stored in the queue.
+
+    /** @brief The number of elements the ring holds. */
+    static constexpr std::size_t capacity = Capacity;
+
+    /**
+     * @brief Only one thread may pop, so producers must never pop to make
+     * room, see OverflowPolicy::DropOldest.
+     */
+    static constexpr bool single_consumer() { return true; }
+
+    /**
+     * @brief Attempts to push an item into the queue.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param item The item to be pushed into the queue. It is left untouched
+     * if the queue is full.
+     * @return true if the item was pushed, false if the queue was full.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, T>
+    bool try_push(U&& item) {
+        auto position = tail.load(std::memory_order_relaxed);
+        if (position - cachedHead == Capacity) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (position - cachedHead == Capacity) {
+                return false;
+            }
+        }
+        buffer[position & mask] = std::forward<U>(item);
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pushes an item into the queue, waiting for the consumer while
+     * the queue is full.
+     *
+     * @tparam U The type of the item being pushed.
+     * @param item The item to be pushed into the queue.
+     *
+     * @note This function is enabled only if U is convertible to T.
+     */
+    template <typename U>
+        requires std::convertible_to<U&&, T>
+    void push(U&& item) {
+        // try_push() leaves the item alone when it fails.
+        while (!try_push(std::forward<U>(item))) {  // NOLINT
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * @brief Attempts to pop an item from the queue.
+     *
+     * @param[out] item The variable to store the popped item.
+     * @return true if an item was successfully popped, false if the queue was
+     * empty.
+     */
+    bool pop(T& item) {
+        auto position = head.load(std::memory_order_relaxed);
+        if (position == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (position == cachedTail) {
+                return false;
+            }
+        }
+        item = std::move(buffer[position & mask]);
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Pushes several items, waiting for the consumer while the queue
+     * is full.
+     *
+     * @tparam It An input iterator whose elements convert to T.
+     * @param first The first item to push.
+     * @param count The number of items to push.
+     */
+    template <typename It>
+    void push_bulk(It first, std::size_t count) {
+        for (; count != 0; --count, ++first) {
+            push(*first);
+        }
+    }
+
+    /**
+     * @brief Pops up to a number of items, publishing the new head once.
+     *
+     * @tparam It An output iterator accepting T.
+     * @param out Where the popped items are written.
+     * @param maxCount The maximum number of items to pop.
+     * @return The number of items popped.
+     */
+    template <typename It>
+    std::size_t pop_bulk(It out, std::size_t maxCount) {
+        auto position = head.load(std::memory_order_relaxed);
+        if (cachedTail - position < maxCount) {
+            cachedTail = tail.load(std::memory_order_acquire);
+        }
+        auto count = std::min(maxCount, cachedTail - position);
+        for (std::size_t i = 0; i < count; ++i, ++out) {
+            *out = std::move(buffer[(position + i) & mask]);
+        }
+        if (count != 0) {
+            head.store(position + count, std::memory_order_release);
+        }
+        return count;
+    }
+};
+
+}  // namespace eventTree::queues
+#endif  // SPSC_RING_QUEUE_H
@@ -0,0 +1,128 @@
+#ifndef READY_SET_H
+#define READY_SET_H
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+namespace eventTree::eventHubs::detail {
+
+/**
+ * @class ReadySet
+ * @brief An atomic bitmap with one bit per slot, set while the slot may hold
+ * events.
+ *
+ * @tparam Storage An indexable container of std::atomic<std::uint64_t> words.
+ * Growable containers must provide grow_to_at_least().
+ *
+ * Bits are hints: a set bit can briefly belong to an empty queue, but a
+ * queue with events always ends up with its bit set. Producers set a bit on
+ * the empty to non-empty transition and consumers clear it on the opposite
+ * one, so the scheduler only visits queues that have work.
+ */
+template <typename Storage>
+class ReadySet {
+   private:
+    static constexpr std::size_t bitsPerWord = 64;
+
+    Storage words{};
+
+    static std::uint64_t maskOf(std::size_t index) {
+        return std::uint64_t{1} << (index % bitsPerWord);
+    }
+
+   public:
+    /**
+     * @brief Makes room for the given number of slots.
+     *
+     * Must be called before a slot with index `slotCount - 1` is published.
+     *
+     * @param slotCount The number of slots that need a bit.
+     */
+    void reserve(std::size_t slotCount) {
+        if constexpr (requires { words.grow_to_at_least(slotCount); }) {
+            words.grow_to_at_least((slotCount + bitsPerWord - 1) /
+                                   bitsPerWord);
+        }
+    }
+
+    /**
+     * @brief Sets the bit of a slot.
+     * @param index The slot index.
+     */
+    void mark(std::size_t index) {
+        auto& word = words[index / bitsPerWord];
+        auto mask = maskOf(index);
+        if ((word.load() & mask) == 0) {
+            word.fetch_or(mask);
+        }
+    }
+
+    /**
+     * @brief Clears the bit of a slot.
+     * @param index The slot index.
+     */
+    void clear(std::size_t index) {
+        words[index / bitsPerWord].fetch_and(~maskOf(index));
+    }
+
+    /**
+     * @brief Checks whether any of the first `count` bits is set.
+     *
+     * Uses sequentially consistent loads, so it can be paired with a waiter
+     * registration to decide whether a consumer may go to sleep.
+     *
+     * @param count The number of slots to consider.
+     * @return true if at least one slot is ready.
+     */
+    bool any(std::size_t count) {
+        auto wordCount = (count + bitsPerWord - 1) / bitsPerWord;
+        for (std::size_t wordIndex = 0; wordIndex < wordCount; ++wordIndex) {
+            if (words[wordIndex].load() != 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Finds the first set bit at or after `start`, wrapping around.
+     * @param start The index to start searching from, less than `count`.
+     * @param count The number of slots to consider.
+     * @return The index of a ready slot, or std::nullopt if none is set.
+     */
+    std::optional<std::size_t> findFrom(std::size_t start,
+                                        std::size_t count) {
+        if (count == 0) {
+            return std::nullopt;
+        }
+        auto wordCount = (count + bitsPerWord - 1) / bitsPerWord;
+        auto firstWord = start / bitsPerWord;
+        auto startMask = ~std::uint64_t{0} << (start % bitsPerWord);
+
+        // One extra step revisits the first word for bits before `start`.
+        for (std::size_t step = 0; step <= wordCount; ++step) {
+            auto wordIndex = (firstWord + step) % wordCount;
+            auto bits = words[wordIndex].load(std::memory_order_relaxed);
+            if (step == 0) {
+                bits &= startMask;
+            } else if (step == wordCount) {
+                bits &= ~startMask;
+            }
+            if (wordIndex == wordCount - 1 && count % bitsPerWord != 0) {
+                bits &= (std::uint64_t{1} << (count % bitsPerWord)) - 1;
+            }
+            if (bits != 0) {
+                return wordIndex * bitsPerWord +
+                       static_cast<std::size_t>(std::countr_zero(bits));
+            }
+        }
+        return std::nullopt;
+    }
+};
+
+}  // namespace eventTree::eventHubs::detail
+
+#endif  // READY_SET_H
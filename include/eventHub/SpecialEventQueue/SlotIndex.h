@@ -0,0 +1,208 @@
+#ifndef SLOT_INDEX_H
+#define SLOT_INDEX_H
+
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/concurrent_vector.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include "ReadySet.h"
+
+namespace eventTree::eventHubs::detail {
+
+/**
+ * @class HashedSlotIndex
+ * @brief Maps arbitrary hashable event types to their slots.
+ *
+ * @tparam EventType The type used to identify different events.
+ * @tparam Slot The per-type storage, constructible from an EventType and its
+ * round-robin index.
+ *
+ * Slots are heap allocated and found through a TBB concurrent hash map. Every
+ * slot is also published, in creation order, to a vector that the round-robin
+ * scheduler walks without hashing.
+ */
+template <typename EventType, typename Slot>
+class HashedSlotIndex {
+   public:
+    /** @brief Ready bits, growing with the number of slots. */
+    using ReadyBits =
+        ReadySet<tbb::concurrent_vector<std::atomic<std::uint64_t>>>;
+
+   private:
+    tbb::concurrent_unordered_map<EventType, std::unique_ptr<Slot>>  // NOLINT
+        slots;                                                        // NOLINT
+    tbb::concurrent_vector<Slot*> order;                              // NOLINT
+    std::atomic<std::size_t> published{0};
+    std::mutex registrationMutex;
+    ReadyBits readyBits;
+
+   public:
+    /**
+     * @brief Get or create the slot for a given event type.
+     * @param type The event type.
+     * @return A reference to the slot for the given event type.
+     */
+    Slot& getOrCreate(const EventType& type) {
+        auto found = slots.find(type);
+        if (found != slots.end()) {
+            return *found->second;
+        }
+
+        std::lock_guard<std::mutex> lock(registrationMutex);
+        found = slots.find(type);
+        if (found != slots.end()) {
+            return *found->second;
+        }
+
+        // Publish to the scheduler before producers can find the slot, so
+        // that any ready bit they set is within the published range.
+        auto index = order.size();
+        readyBits.reserve(index + 1);
+        auto slot = std::make_unique<Slot>(type, index);
+        auto& created = *slot;
+        order.push_back(&created);
+        published.store(order.size(), std::memory_order_release);
+        slots.emplace(type, std::move(slot));
+        return created;
+    }
+
+    /**
+     * @brief Find the slot for a given event type without creating it.
+     * @param type The event type.
+     * @return The slot, or nullptr if the type was never used.
+     */
+    Slot* find(const EventType& type) {
+        auto found = slots.find(type);
+        return found != slots.end() ? found->second.get() : nullptr;
+    }
+
+    /**
+     * @brief Number of slots visible to the scheduler.
+     * @return The count of published slots.
+     */
+    [[nodiscard]] std::size_t size() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Access a slot by its creation order.
+     * @param index Position in creation order, must be less than size().
+     * @return A reference to the slot.
+     */
+    Slot& operator[](std::size_t index) { return *order[index]; }
+
+    /**
+     * @brief The ready bits of the slots, indexed like operator[].
+     * @return A reference to the ready set.
+     */
+    ReadyBits& ready() { return readyBits; }
+};
+
+/**
+ * @class DenseSlotIndex
+ * @brief Maps the values of a small enumeration directly to their slots.
+ *
+ * @tparam EventType An enumeration with a one byte underlying type.
+ * @tparam Slot The per-type storage, constructible from an EventType and its
+ * round-robin index.
+ *
+ * Both the lookup table and the round-robin order are flat arrays indexed by
+ * value, so finding a slot on the hot paths is a single atomic load. Slots are
+ * created lazily, under a mutex, the first time their type is used.
+ */
+template <typename EventType, typename Slot>
+class DenseSlotIndex {
+   private:
+    using IndexType = std::make_unsigned_t<std::underlying_type_t<EventType>>;
+
+    static constexpr std::size_t capacity =
+        std::size_t{std::numeric_limits<IndexType>::max()} + 1;
+
+   public:
+    /** @brief Ready bits for every possible value, stored inline. */
+    using ReadyBits =
+        ReadySet<std::array<std::atomic<std::uint64_t>, (capacity + 63) / 64>>;
+
+   private:
+    std::array<std::atomic<Slot*>, capacity> byType{};
+    std::array<Slot*, capacity> order{};
+    std::array<std::unique_ptr<Slot>, capacity> owned;
+    std::atomic<std::size_t> published{0};
+    std::mutex registrationMutex;
+    ReadyBits readyBits;
+
+    static std::size_t indexOf(const EventType& type) {
+        return static_cast<IndexType>(type);
+    }
+
+   public:
+    /**
+     * @brief Get or create the slot for a given event type.
+     * @param type The event type.
+     * @return A reference to the slot for the given event type.
+     */
+    Slot& getOrCreate(const EventType& type) {
+        auto& entry = byType[indexOf(type)];
+        if (auto* slot = entry.load(std::memory_order_acquire)) {
+            return *slot;
+        }
+
+        std::lock_guard<std::mutex> lock(registrationMutex);
+        if (auto* slot = entry.load(std::memory_order_relaxed)) {
+            return *slot;
+        }
+
+        // Publish to the scheduler before producers can find the slot, so
+        // that any ready bit they set is within the published range.
+        auto count = published.load(std::memory_order_relaxed);
+        auto& slot = owned[indexOf(type)];
+        slot = std::make_unique<Slot>(type, count);
+        order[count] = slot.get();
+        published.store(count + 1, std::memory_order_release);
+        entry.store(slot.get(), std::memory_order_release);
+        return *slot;
+    }
+
+    /**
+     * @brief Find the slot for a given event type without creating it.
+     * @param type The event type.
+     * @return The slot, or nullptr if the type was never used.
+     */
+    Slot* find(const EventType& type) {
+        return byType[indexOf(type)].load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Number of slots visible to the scheduler.
+     * @return The count of published slots.
+     */
+    [[nodiscard]] std::size_t size() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Access a slot by its creation order.
+     * @param index Position in creation order, must be less than size().
+     * @return A reference to the slot.
+     */
+    Slot& operator[](std::size_t index) { return *order[index]; }
+
+    /**
+     * @brief The ready bits of the slots, indexed like operator[].
+     * @return A reference to the ready set.
+     */
+    ReadyBits& ready() { return readyBits; }
+};
+
+}  // namespace eventTree::eventHubs::detail
+
+#endif  // SLOT_INDEX_H
@@ -6,8 +6,24 @@
  * with the following features:
  * - Template-based design for handling various event and handler types
  * - Thread-safe operations using TBB concurrent containers
- * - Support for multiple event types and handlers
+ * - Flat, enum-indexed storage when the event type is a small enumeration
+ * - Support for multiple event types and handlers, stored side by side;
+ *   move-only handlers such as InplaceFunction are accepted
  * - Fair event processing to prevent starvation of less frequent event types
+ * - Optional weighted deficit round robin, charged by event count or by
+ *   measured handler time
+ * - An optional serial mode that runs each event type's events one at a time
+ *   and in order, while different types still run in parallel
+ * - Per-type overflow policies for bounded queues: block, drop the newest or
+ *   the oldest event, or reject the push
+ * - Explicit producer and consumer tokens for queues that support them
+ * - Bulk enqueue, and bulk dequeue of several events per type visit, for
+ *   queues that support it
+ * - Optional per-event deadlines, earliest-deadline-first scheduling, and
+ *   per-type counts of events dropped because they expired
+ * - A ready bitmap so that dispatch only visits event types with pending events
+ * - Blocking waits for consumers that only cost producers a syscall when a
+ *   consumer is actually parked
  * - Concept-based constraints to ensure type safety and correct usage
  *
  * The main class, SpecialEventQueue, allows users to enqueue events, process
@@ -18,16 +34,25 @@
 #ifndef SPECIAL_EVENT_QUEUE_H
 #define SPECIAL_EVENT_QUEUE_H
 
-#include <tbb/concurrent_unordered_map.h>
-#include <tbb/concurrent_vector.h>
-
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
-#include <tuple>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <optional>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "EventCount.h"
+#include "EventSlot.h"
+#include "SlotIndex.h"
 
 namespace eventTree::eventHubs {
 
@@ -54,6 +79,15 @@ concept HashableConcept = requires(T type) {
     { std::hash<T>{}(type) } -> std::convertible_to<std::size_t>;
 };
 
+/**
+ * @brief Concept to check if a type is an enumeration small enough to index
+ * flat arrays with.
+ * @tparam T The type to check.
+ */
+template <typename T>
+concept DenseEnumConcept =
+    std::is_enum_v<T> && sizeof(std::underlying_type_t<T>) == 1;
+
 /**
  * @brief Concept defining the requirements for a Queue type.
  * @tparam Q The queue type to check.
@@ -77,50 +111,1245 @@ template <typename H, typename Q>
 concept HandlerConcept = std::invocable<H, const typename Q::value_type&>;
 
 /**
- * @class SpecialEventQueue
- * @brief A thread-safe event queue system supporting multiple event types and
- * handlers.
+ * @brief Concept for queues that can also push and pop several elements in one
+ * operation. Queues without it are driven one element at a time.
+ * @tparam Q The queue type to check.
+ */
+template <typename Q>
+concept BulkQueueConcept =
+    QueueConcept<Q> && requires(Q queue, typename Q::value_type* items,
+                                std::size_t count) {
+        { queue.push_bulk(items, count) } -> std::same_as<void>;
+        { queue.pop_bulk(items, count) } -> std::same_as<std::size_t>;
+    };
+
+/**
+ * @brief Concept for queues of limited capacity, whose push() waits while
+ * they are full.
+ *
+ * try_push() must leave the item untouched when it fails.
+ *
+ * @tparam Q The queue type to check.
+ */
+template <typename Q>
+concept BoundedQueueConcept =
+    QueueConcept<Q> && requires(Q queue, typename Q::value_type&& rvalue) {
+        { queue.try_push(std::move(rvalue)) } -> std::same_as<bool>;
+    };
+
+/**
+ * @brief Concept for queues that may report that only one thread can pop
+ * from them, such as SpscRingQueue.
+ *
+ * Producers then must never pop, so OverflowPolicy::DropOldest is refused.
+ *
+ * @tparam Q The queue type to check.
+ */
+template <typename Q>
+concept SingleConsumerQueueConcept =
+    QueueConcept<Q> && requires(const Q& queue) {
+        { queue.single_consumer() } -> std::convertible_to<bool>;
+    };
+
+/**
+ * @brief Concept for queues whose producers and consumers can hold explicit
+ * tokens, e.g. to skip a thread-local lookup on every call.
+ * @tparam Q The queue type to check.
+ */
+template <typename Q>
+concept TokenQueueConcept =
+    QueueConcept<Q> &&
+    requires(Q queue, typename Q::producer_token& producer,
+             typename Q::consumer_token& consumer,
+             typename Q::value_type& lvalue, typename Q::value_type&& rvalue) {
+        { queue.producerToken() } -> std::same_as<typename Q::producer_token>;
+        { queue.consumerToken() } -> std::same_as<typename Q::consumer_token>;
+        { queue.push(producer, std::move(rvalue)) } -> std::same_as<void>;
+        { queue.pop(consumer, lvalue) } -> std::same_as<bool>;
+    };
+
+/**
+ * @brief Concept for token queues that also move several elements per call
+ * through a token.
+ * @tparam Q The queue type to check.
+ */
+template <typename Q>
+concept TokenBulkQueueConcept =
+    BulkQueueConcept<Q> && TokenQueueConcept<Q> &&
+    requires(Q queue, typename Q::producer_token& producer,
+             typename Q::consumer_token& consumer,
+             typename Q::value_type* items, std::size_t count) {
+        { queue.push_bulk(producer, items, count) } -> std::same_as<void>;
+        { queue.pop_bulk(consumer, items, count) } -> std::same_as<std::size_t>;
+    };
+
+/**
+ * @brief Concept to check if a queue template can store other element types.
+ *
+ * The queue is instantiated once more to store each event with its deadline.
+ *
+ * @tparam Q The queue type to check.
+ */
+template <typename Q>
+concept RebindableQueueConcept =
+    QueueConcept<typename detail::RebindQueue<
+        Q, detail::Timed<typename Q::value_type>>::type>;
+
+/**
+ * @brief The point in time after which an event is dropped instead of handled.
+ */
+using EventDeadline = std::chrono::steady_clock::time_point;
+
+/**
+ * @struct DispatchCursor
+ * @brief A round-robin position owned by a single consumer.
+ *
+ * Aligned to a cache line so that cursors of different consumers never share
+ * one.
+ */
+struct alignas(64) DispatchCursor {  // NOLINT
+    std::size_t position = 0;  ///< The next position to visit.
+};
+
+/**
+ * @enum SlotOrdering
+ * @brief Whether events of one type may be handled by several consumers at
+ * the same time.
+ */
+enum class SlotOrdering : std::uint8_t {
+    Concurrent, /**< Any consumer may take the next event of any type. */
+    Serial      /**< A type is owned by one consumer while its handlers run. */
+};
+
+/**
+ * @enum Fairness
+ * @brief How the round-robin scheduler shares dispatch between event types.
+ */
+enum class Fairness : std::uint8_t {
+    RoundRobin,       /**< One event per type and turn. */
+    Deficit,          /**< Weighted deficit round robin, charged per event. */
+    DeficitByTime,    /**< Weighted deficit round robin, charged per
+                           nanosecond spent in the handlers. */
+    EarliestDeadline  /**< The head with the earliest deadline first; heads
+                           without one, or with equal ones, in round-robin
+                           order. */
+};
+
+/**
+ * @enum OverflowPolicy
+ * @brief What enqueueing does when the queue of an event type is full. Only
+ * bounded queues are ever full.
+ */
+enum class OverflowPolicy : std::uint8_t {
+    Block,      /**< Wait until a consumer makes room. */
+    DropNewest, /**< Drop the event being enqueued. */
+    DropOldest, /**< Drop the type's oldest queued events to make room;
+                     refused for queues with a single consumer. */
+    Reject      /**< Leave the event out and report it to the caller. */
+};
+
+/**
+ * @enum EnqueueStatus
+ * @brief The outcome of an enqueue.
+ */
+enum class EnqueueStatus : std::uint8_t {
+    Enqueued, /**< The event is queued. */
+    Dropped,  /**< The queue was full and the event was dropped. */
+    Rejected  /**< The queue was full and the event was not queued. */
+};
+
+/**
+ * @struct SchedulingOptions
+ * @brief Tunes how a SpecialEventQueue picks the next event.
+ */
+struct SchedulingOptions {
+    /** @brief Whether a type may be handled by several consumers at once. */
+    SlotOrdering ordering = SlotOrdering::Concurrent;
+
+    /** @brief How dispatch is shared between event types. */
+    Fairness fairness = Fairness::RoundRobin;
+
+    /**
+     * @brief Handler time granted per unit of weight and turn when charging
+     * by time.
+     */
+    std::chrono::nanoseconds timeQuantum{10000};  // NOLINT
+
+    /**
+     * @brief Events processBatch() and processFor() take from a type per
+     * visit, at most maxBurst. Only used with Fairness::RoundRobin.
+     */
+    std::size_t burst = 1;
+
+    /** @brief Upper bound of burst. */
+    static constexpr std::size_t maxBurst = 32;
+};
+
+namespace detail {
+
+/**
+ * @class TimedIterator
+ * @brief Reads events from an iterator as Timed events without a deadline,
+ * so a range can be handed to a queue's push_bulk() without a copy.
+ * @tparam It The iterator over the events.
+ * @tparam Event The event type stored in the queue.
+ */
+template <typename It, typename Event>
+class TimedIterator {
+   private:
+    It it;
+
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Timed<Event>;
+    using difference_type = std::ptrdiff_t;
+
+    /**
+     * @brief Wraps an iterator.
+     * @param it The position of the first event.
+     */
+    explicit TimedIterator(It it) : it(std::move(it)) {}
+
+    /** @brief The current event, without a deadline. */
+    value_type operator*() const { return value_type{Event(*it)}; }
+
+    /** @brief Moves to the next event. */
+    TimedIterator& operator++() {
+        ++it;
+        return *this;
+    }
+
+    /** @brief Moves to the next event. */
+    TimedIterator operator++(int) {
+        auto previous = *this;
+        ++it;
+        return previous;
+    }
+};
+
+/**
+ * @struct NoToken
+ * @brief Stands in for the tokens of queues that have none.
+ */
+struct NoToken {};
+
+/**
+ * @struct QueueTokens
+ * @brief The producer and consumer token types of a queue.
+ * @tparam Q The queue type.
+ */
+template <typename Q>
+struct QueueTokens {
+    using producer = NoToken;  ///< The queue has no producer tokens.
+    using consumer = NoToken;  ///< The queue has no consumer tokens.
+};
+
+template <TokenQueueConcept Q>
+struct QueueTokens<Q> {
+    using producer = typename Q::producer_token;  ///< Producer token type.
+    using consumer = typename Q::consumer_token;  ///< Consumer token type.
+};
+
+/**
+ * @class TokenSet
+ * @brief One token per slot, created the first time the slot is used.
+ * @tparam Token The token type.
+ */
+template <typename Token>
+class TokenSet {
+   private:
+    std::vector<std::optional<Token>> tokens;
+
+   public:
+    /**
+     * @brief Finds the token of a slot.
+     * @tparam Make A callable returning a new token.
+     * @param index The slot index.
+     * @param make Creates the token if the slot has none yet.
+     * @return The slot's token.
+     */
+    template <typename Make>
+    Token& at(std::size_t index, Make&& make) {
+        if (index >= tokens.size()) {
+            tokens.resize(index + 1);
+        }
+        if (!tokens[index]) {
+            tokens[index].emplace(std::invoke(std::forward<Make>(make)));
+        }
+        return *tokens[index];
+    }
+};
+
+/**
+ * @class BasicSpecialEventQueue
+ * @brief The scheduling and dispatch logic shared by every SpecialEventQueue.
  *
  * @tparam EventType The type used to identify different events.
  * @tparam HandlerType The type of the event handlers.
  * @tparam QueueType The type of queue used to store events.
+ * @tparam SlotIndex The container mapping event types to their slots.
  */
-template <typename EventType, typename HandlerType, typename QueueType>
-    requires HashableConcept<EventType> && DefaultConstructible<QueueType> &&
-             QueueConcept<QueueType> && HandlerConcept<HandlerType, QueueType>
-class SpecialEventQueue {
+template <typename EventType, typename HandlerType, typename QueueType,
+          template <typename, typename> typename SlotIndex>
+class BasicSpecialEventQueue {
    private:
-    tbb::concurrent_unordered_map<EventType, QueueType> queues;  // NOLINT
-    tbb::concurrent_unordered_multimap<EventType, HandlerType>   // NOLINT
-        handlers;                                                // NOLINT
-    tbb::concurrent_vector<EventType> eventTypes;                // NOLINT
-    std::atomic<std::uint64_t> currentIndex{0};
+    using Event = typename QueueType::value_type;
+    using Stored = Timed<Event>;
+    using StoredQueue = typename RebindQueue<QueueType, Stored>::type;
+    using Slot = EventSlot<EventType, HandlerType, StoredQueue>;
 
+   public:
     /**
-     * @brief Get or create a queue for a given event type.
-     * @param type The event type.
-     * @return A reference to the queue for the given event type.
+     * @class ProducerToken
+     * @brief A producer's own tokens for the per-type queues, see
+     * producerToken().
+     */
+    class ProducerToken {
+        friend class BasicSpecialEventQueue;
+        ProducerToken() = default;
+        TokenSet<typename QueueTokens<StoredQueue>::producer> tokens;
+    };
+
+    /**
+     * @class ConsumerToken
+     * @brief A consumer's round-robin cursor together with its own tokens for
+     * the per-type queues, see consumerToken().
+     */
+    class ConsumerToken : public DispatchCursor {
+        friend class BasicSpecialEventQueue;
+        ConsumerToken() = default;
+        TokenSet<typename QueueTokens<StoredQueue>::consumer> tokens;
+    };
+
+    /**
+     * @class Channel
+     * @brief A handle on the queue of one event type, see channel().
+     *
+     * Enqueueing through a channel goes straight to the type's queue and its
+     * ready bookkeeping, without looking the type up. Channels are cheap to
+     * copy and stay valid as long as the queue that made them.
+     */
+    class Channel {
+        friend class BasicSpecialEventQueue;
+
+        Channel(BasicSpecialEventQueue& owner, Slot& slot)
+            : owner(&owner), slot(&slot) {}
+
+        BasicSpecialEventQueue* owner;  ///< The queue the slot belongs to.
+        Slot* slot;                     ///< The slot of the event type.
+
+       public:
+        /**
+         * @brief The event type of this channel.
+         * @return The event type.
+         */
+        [[nodiscard]] const EventType& type() const { return slot->type; }
+
+        /**
+         * @brief Enqueue an event, see BasicSpecialEventQueue::enqueue().
+         * @tparam T The type of the event to enqueue.
+         * @param event The event to enqueue.
+         * @param deadline The latest time the event may be dispatched at;
+         * EventDeadline::max() for none.
+         * @return Whether the event was queued.
+         */
+        template <typename T>
+        EnqueueStatus push(T&& event,
+                           EventDeadline deadline = EventDeadline::max()) {
+            return owner->pushEvent(
+                *slot, nullptr,
+                Stored{Event(std::forward<T>(event)), deadline});
+        }
+
+        /**
+         * @brief Enqueue an event through a producer's token.
+         * @tparam T The type of the event to enqueue.
+         * @param producer The producer's token, made by the same queue.
+         * @param event The event to enqueue.
+         * @param deadline The latest time the event may be dispatched at;
+         * EventDeadline::max() for none.
+         * @return Whether the event was queued.
+         */
+        template <typename T>
+        EnqueueStatus push(ProducerToken& producer, T&& event,
+                           EventDeadline deadline = EventDeadline::max()) {
+            return owner->pushEvent(
+                *slot, &producer,
+                Stored{Event(std::forward<T>(event)), deadline});
+        }
+
+        /**
+         * @brief Enqueue a range of events, see
+         * BasicSpecialEventQueue::enqueueBulk().
+         * @tparam It A forward iterator over the events.
+         * @param first The first event.
+         * @param last One past the last event.
+         * @return The number of events queued.
+         */
+        template <typename It>
+            requires std::derived_from<
+                typename std::iterator_traits<It>::iterator_category,
+                std::forward_iterator_tag>
+        std::size_t pushBulk(It first, It last) {
+            return owner->pushRange(*slot, nullptr, first, last);
+        }
+
+        /**
+         * @brief Enqueue a range of events through a producer's token.
+         * @tparam It A forward iterator over the events.
+         * @param producer The producer's token, made by the same queue.
+         * @param first The first event.
+         * @param last One past the last event.
+         * @return The number of events queued.
+         */
+        template <typename It>
+            requires std::derived_from<
+                typename std::iterator_traits<It>::iterator_category,
+                std::forward_iterator_tag>
+        std::size_t pushBulk(ProducerToken& producer, It first, It last) {
+            return owner->pushRange(*slot, &producer, first, last);
+        }
+    };
+
+   private:
+    SlotIndex<EventType, Slot> slots;
+    std::atomic<std::size_t> currentIndex{0};
+    EventCount eventCount;  ///< Parks idle consumers, see waitForEvents().
+    SchedulingOptions options;
+
+    /**
+     * @brief Clears the ready bit of a slot that ran out of events.
+     *
+     * A producer may push between the decrement that emptied the slot and the
+     * clear, so the count is checked again and the bit restored if needed.
+     *
+     * @param slot The slot that became empty.
+     */
+    void markIdle(Slot& slot) {
+        slots.ready().clear(slot.index);
+        if (slot.pending.load() != 0) {
+            slots.ready().mark(slot.index);
+        }
+    }
+
+    /**
+     * @brief Pushes an event into its slot and wakes a consumer.
+     * @param slot The slot of the event's type.
+     * @param producer The producer's token, or nullptr.
+     * @param event The event and its deadline.
+     * @return Whether the event was queued.
+     */
+    EnqueueStatus pushEvent(Slot& slot, ProducerToken* producer,
+                            Stored&& event) {
+        // Counted before the push so a consumer never sees an event that
+        // pending does not account for.
+        if (slot.pending.fetch_add(1) == 0) {
+            slots.ready().mark(slot.index);
+        }
+        if constexpr (BoundedQueueConcept<StoredQueue>) {
+            auto policy = static_cast<OverflowPolicy>(
+                slot.overflow.load(std::memory_order_relaxed));
+            if (policy != OverflowPolicy::Block) {
+                auto status = pushOrOverflow(slot, policy, std::move(event));
+                if (status == EnqueueStatus::Enqueued) {
+                    eventCount.wakeOne();
+                }
+                return status;
+            }
+        }
+        if constexpr (TokenQueueConcept<StoredQueue>) {
+            if (producer != nullptr) {
+                auto& token = producer->tokens.at(
+                    slot.index, [&slot] { return slot.queue.producerToken(); });
+                slot.queue.push(token, std::move(event));
+                eventCount.wakeOne();
+                return EnqueueStatus::Enqueued;
+            }
+        }
+        slot.queue.push(std::move(event));
+        eventCount.wakeOne();
+        return EnqueueStatus::Enqueued;
+    }
+
+    /**
+     * @brief Pushes a range of events into their slot, see enqueueBulk().
+     * @param slot The slot of the events' type.
+     * @param producer The producer's token, or nullptr.
+     * @param first The first event.
+     * @param last One past the last event.
+     * @return The number of events queued.
+     */
+    template <typename It>
+    std::size_t pushRange(Slot& slot, ProducerToken* producer, It first,
+                          It last) {
+        auto count = static_cast<std::size_t>(std::distance(first, last));
+        if (count == 0) {
+            return 0;
+        }
+        if constexpr (BoundedQueueConcept<StoredQueue>) {
+            if (static_cast<OverflowPolicy>(slot.overflow.load(
+                    std::memory_order_relaxed)) != OverflowPolicy::Block) {
+                std::size_t queued = 0;
+                for (; first != last; ++first) {
+                    queued +=
+                        pushEvent(slot, producer, Stored{Event(*first)}) ==
+                        EnqueueStatus::Enqueued;
+                }
+                return queued;
+            }
+        }
+        if (slot.pending.fetch_add(count) == 0) {
+            slots.ready().mark(slot.index);
+        }
+        if constexpr (TokenQueueConcept<StoredQueue>) {
+            if (producer != nullptr) {
+                auto& token = producer->tokens.at(
+                    slot.index, [&slot] { return slot.queue.producerToken(); });
+                if constexpr (TokenBulkQueueConcept<StoredQueue>) {
+                    slot.queue.push_bulk(token, TimedIterator<It, Event>(first),
+                                         count);
+                } else {
+                    for (; first != last; ++first) {
+                        slot.queue.push(token, Stored{Event(*first)});
+                    }
+                }
+                eventCount.wakeOne();
+                return count;
+            }
+        }
+        if constexpr (BulkQueueConcept<StoredQueue>) {
+            slot.queue.push_bulk(TimedIterator<It, Event>(first), count);
+        } else {
+            for (; first != last; ++first) {
+                slot.queue.push(Stored{Event(*first)});
+            }
+        }
+        eventCount.wakeOne();
+        return count;
+    }
+
+    /**
+     * @brief Pushes an event into a bounded queue, applying the type's
+     * overflow policy while the queue is full.
+     * @param slot The slot of the event's type; the event is already counted
+     * as pending.
+     * @param policy The type's overflow policy, other than Block.
+     * @param event The event and its deadline.
+     * @return Whether the event was queued.
+     */
+    EnqueueStatus pushOrOverflow(Slot& slot, OverflowPolicy policy,
+                                 Stored&& event) {
+        while (!slot.queue.try_push(std::move(event))) {
+            if (policy == OverflowPolicy::DropOldest) {
+                Stored oldest;
+                if (slot.queue.pop(oldest)) {
+                    slot.dropped.fetch_add(1, std::memory_order_relaxed);
+                    slot.pending.fetch_sub(1);
+                }
+                continue;
+            }
+            if (slot.pending.fetch_sub(1) == 1) {
+                markIdle(slot);
+            }
+            if (policy == OverflowPolicy::DropNewest) {
+                slot.dropped.fetch_add(1, std::memory_order_relaxed);
+                return EnqueueStatus::Dropped;
+            }
+            return EnqueueStatus::Rejected;
+        }
+        return EnqueueStatus::Enqueued;
+    }
+
+    /**
+     * @brief Pops the next event of a slot.
+     * @param slot The slot.
+     * @param[out] event Receives the event.
+     * @param consumer The consumer's token, or nullptr.
+     * @return true if an event was popped.
+     */
+    bool popEvent(Slot& slot, Stored& event, ConsumerToken* consumer) {
+        if constexpr (TokenQueueConcept<StoredQueue>) {
+            if (consumer != nullptr) {
+                auto& token = consumer->tokens.at(
+                    slot.index, [&slot] { return slot.queue.consumerToken(); });
+                return slot.queue.pop(token, event);
+            }
+        }
+        return slot.queue.pop(event);
+    }
+
+    /**
+     * @brief Whether one of the deficit round robin modes is in use.
+     * @return true if turns are charged against a deficit.
+     */
+    [[nodiscard]] bool chargesDeficit() const {
+        return options.fairness == Fairness::Deficit ||
+               options.fairness == Fairness::DeficitByTime;
+    }
+
+    /**
+     * @brief Checks whether an event's deadline has passed.
+     * @param event The stored event.
+     * @return true if the event must be dropped.
+     */
+    static bool expired(const Stored& event) {
+        // Events without a deadline never pay for reading the clock.
+        return event.deadline != EventDeadline::max() &&
+               std::chrono::steady_clock::now() >= event.deadline;
+    }
+
+    /**
+     * @brief Pops the next event in round-robin order.
+     *
+     * @param[in,out] position The round-robin cursor. On return it points
+     * right after the event type that was visited last.
+     * @param[out] event Receives the popped event.
+     * @param consumer The consumer's token, or nullptr.
+     * @return The slot the event was taken from, or nullptr if none was.
+     */
+    Slot* claim(std::size_t& position, Stored& event,
+                ConsumerToken* consumer) {
+        if (options.fairness == Fairness::EarliestDeadline) {
+            return claimEarliest(position, event, consumer);
+        }
+
+        auto eventTypeCount = slots.size();
+        if (eventTypeCount == 0) {
+            return nullptr;
+        }
+
+        auto start = position % eventTypeCount;
+        std::size_t visited = 0;
+        // Deficit round robin bookkeeping for types found paying off debt.
+        std::optional<std::size_t> firstDebtor;
+        std::int64_t rounds = 1;
+        auto fewestRounds = std::numeric_limits<std::int64_t>::max();
+        while (visited < eventTypeCount) {
+            auto index = slots.ready().findFrom(start, eventTypeCount);
+            if (!index) {
+                return nullptr;
+            }
+            // The next call starts right after the type visited now.
+            position = *index + 1;
+
+            auto& slot = slots[*index];
+            if (chargesDeficit()) {
+                // Paying off debt takes whole rounds, so it does not count as
+                // a visit. Once a full pass found every ready type in debt,
+                // each is given the rounds the closest one still needs in
+                // one step rather than one round per pass.
+                if (!replenish(slot, rounds)) {
+                    if (firstDebtor == *index) {
+                        rounds = fewestRounds;
+                        fewestRounds = std::numeric_limits<std::int64_t>::max();
+                    } else if (!firstDebtor) {
+                        firstDebtor = *index;
+                    }
+                    fewestRounds = std::min(fewestRounds, roundsToCredit(slot));
+                    start = (*index + 1) % eventTypeCount;
+                    continue;
+                }
+                // Keep serving this type until its credit runs out.
+                position = *index;
+            }
+            ++visited;
+            if (options.ordering == SlotOrdering::Serial) {
+                if (claimSerial(slot, event, consumer)) {
+                    if (!expired(event)) {
+                        return &slot;
+                    }
+                    // Dropping is not a visit; the type is tried again.
+                    slot.dropped.fetch_add(1, std::memory_order_relaxed);
+                    release(slot);
+                    --visited;
+                    start = *index;
+                    continue;
+                }
+                position = *index + 1;
+                start = (*index + 1) % eventTypeCount;
+                continue;
+            }
+            if (popEvent(slot, event, consumer)) {
+                if (slot.pending.fetch_sub(1) == 1) {
+                    markIdle(slot);
+                }
+                if (!expired(event)) {
+                    return &slot;
+                }
+                slot.dropped.fetch_add(1, std::memory_order_relaxed);
+                --visited;
+                start = *index;
+                continue;
+            }
+            position = *index + 1;
+            if (slot.pending.load() == 0) {
+                markIdle(slot);
+            }
+            start = (*index + 1) % eventTypeCount;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Takes ownership of a slot and pops its next event.
+     *
+     * While a slot is owned its ready bit stays clear and its pending count
+     * still includes the event being handled, so producers never set the bit
+     * again and no other consumer visits the slot until release().
+     *
+     * @param slot A slot whose ready bit was found set.
+     * @param[out] event Receives the popped event.
+     * @param consumer The consumer's token, or nullptr.
+     * @return true if the slot is now owned by the caller.
+     */
+    bool claimSerial(Slot& slot, Stored& event, ConsumerToken* consumer) {
+        if (slot.owned.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
+        slots.ready().clear(slot.index);
+        if (popEvent(slot, event, consumer)) {
+            return true;
+        }
+        // The producer that set the bit has not finished its push yet.
+        slot.owned.store(false, std::memory_order_release);
+        if (slot.pending.load() != 0) {
+            slots.ready().mark(slot.index);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Makes sure a slot's next unexpired event is staged as its head,
+     * dropping expired ones on the way.
+     *
+     * A staged head still counts as pending.
+     *
+     * @param slot A slot whose ready bit was found set.
+     * @param consumer The consumer's token, or nullptr.
+     * @return The deadline of the head, or std::nullopt if there is none.
+     */
+    std::optional<EventDeadline> stageHead(Slot& slot,
+                                           ConsumerToken* consumer) {
+        std::lock_guard lock(slot.headMutex);
+        while (true) {
+            if (!slot.head) {
+                Stored event;
+                if (!popEvent(slot, event, consumer)) {
+                    if (slot.pending.load() == 0) {
+                        markIdle(slot);
+                    }
+                    return std::nullopt;
+                }
+                slot.head = std::move(event);
+            }
+            if (!expired(*slot.head)) {
+                return slot.head->deadline;
+            }
+            slot.head.reset();
+            slot.dropped.fetch_add(1, std::memory_order_relaxed);
+            if (slot.pending.fetch_sub(1) == 1) {
+                markIdle(slot);
+            }
+        }
+    }
+
+    /**
+     * @brief Takes the staged head with the earliest deadline.
+     *
+     * Ready slots are compared in round-robin order starting at the cursor
+     * and only a strictly earlier deadline wins, so types whose events carry
+     * no deadline, or the same one, still take turns.
+     *
+     * @param[in,out] position The round-robin cursor. On return it points
+     * right after the event type the event was taken from.
+     * @param[out] event Receives the event.
+     * @param consumer The consumer's token, or nullptr.
+     * @return The slot the event was taken from, or nullptr if none was.
      */
-    QueueType& getQueue(const EventType& type) {
-        auto [iter, inserted] =
-            queues.emplace(std::piecewise_construct,
-                           std::forward_as_tuple(type), std::tuple<>());
-        if (inserted) {
-            eventTypes.push_back(type);
+    Slot* claimEarliest(std::size_t& position, Stored& event,
+                        ConsumerToken* consumer) {
+        auto eventTypeCount = slots.size();
+        if (eventTypeCount == 0) {
+            return nullptr;
+        }
+
+        // Another consumer may take the chosen head first; then look again.
+        while (true) {
+            Slot* earliest = nullptr;
+            auto deadline = EventDeadline::max();
+            auto begin = position % eventTypeCount;
+            std::optional<std::size_t> reached;  ///< Distance from begin.
+            for (auto index = slots.ready().findFrom(begin, eventTypeCount);
+                 index; index = slots.ready().findFrom(
+                            (*index + 1) % eventTypeCount, eventTypeCount)) {
+                auto distance = (*index + eventTypeCount - begin) %
+                                eventTypeCount;
+                if (reached && distance <= *reached) {
+                    break;  // Wrapped around.
+                }
+                reached = distance;
+
+                auto& slot = slots[*index];
+                if (slot.owned.load(std::memory_order_relaxed)) {
+                    continue;
+                }
+                auto head = stageHead(slot, consumer);
+                if (head && (earliest == nullptr || *head < deadline)) {
+                    earliest = &slot;
+                    deadline = *head;
+                }
+            }
+            if (earliest == nullptr) {
+                return nullptr;
+            }
+            if (take(*earliest, event)) {
+                position = earliest->index + 1;
+                return earliest;
+            }
+        }
+    }
+
+    /**
+     * @brief Takes the staged head of a slot.
+     * @param slot The slot chosen by claimEarliest().
+     * @param[out] event Receives the head.
+     * @return true if the head was taken; false if it was gone already.
+     */
+    bool take(Slot& slot, Stored& event) {
+        auto serial = options.ordering == SlotOrdering::Serial;
+        if (serial && slot.owned.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
+        std::unique_lock lock(slot.headMutex);
+        if (!slot.head) {
+            lock.unlock();
+            if (serial) {
+                slot.owned.store(false, std::memory_order_release);
+            }
+            return false;
+        }
+        event = std::move(*slot.head);
+        slot.head.reset();
+        lock.unlock();
+
+        if (serial) {
+            // As in claimSerial(), release() restores the bit and the count.
+            slots.ready().clear(slot.index);
+        } else if (slot.pending.fetch_sub(1) == 1) {
+            markIdle(slot);
+        }
+        return true;
+    }
+
+    /**
+     * @brief The credit a slot earns per deficit round robin round.
+     * @param slot The slot.
+     * @return The quantum, in events or nanoseconds.
+     */
+    std::int64_t quantumOf(const Slot& slot) const {
+        std::int64_t quantum = slot.weight.load(std::memory_order_relaxed);
+        if (options.fairness == Fairness::DeficitByTime) {
+            quantum *= options.timeQuantum.count();
+        }
+        return std::max<std::int64_t>(quantum, 1);
+    }
+
+    /**
+     * @brief The rounds a slot in debt still needs to get back to credit.
+     * @param slot The slot.
+     * @return At least one.
+     */
+    std::int64_t roundsToCredit(const Slot& slot) const {
+        auto deficit = slot.deficit.load(std::memory_order_relaxed);
+        return deficit > 0 ? 1 : -deficit / quantumOf(slot) + 1;
+    }
+
+    /**
+     * @brief Starts a new deficit round robin turn for a slot that has no
+     * credit left.
+     * @param slot The slot being visited.
+     * @param rounds The number of rounds to credit at once.
+     * @return true if the slot has credit to spend in this turn.
+     */
+    bool replenish(Slot& slot, std::int64_t rounds = 1) {
+        auto deficit = slot.deficit.load(std::memory_order_relaxed);
+        if (deficit > 0) {
+            return true;
+        }
+        auto quantum = quantumOf(slot) * rounds;
+        while (!slot.deficit.compare_exchange_weak(deficit, deficit + quantum,
+                                                   std::memory_order_relaxed)) {
+            if (deficit > 0) {
+                return true;
+            }
+        }
+        return deficit + quantum > 0;
+    }
+
+    /**
+     * @brief Runs the handlers of a claimed event and charges their cost.
+     * @param slot The slot the event was taken from.
+     * @param event The event to handle.
+     * @return true if the slot's turn is over and the cursor should move on.
+     */
+    bool run(Slot& slot, const Event& event) {
+        if (!chargesDeficit()) {
+            slot.handlers.invoke(event);
+            release(slot);
+            return true;
+        }
+
+        std::int64_t cost = 1;
+        if (options.fairness == Fairness::DeficitByTime) {
+            auto start = std::chrono::steady_clock::now();
+            slot.handlers.invoke(event);
+            cost = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+        } else {
+            slot.handlers.invoke(event);
+        }
+        release(slot);
+
+        auto deficit =
+            slot.deficit.fetch_sub(cost, std::memory_order_relaxed) - cost;
+        // As in classic DRR, a type that ran dry does not bank its credit,
+        // but any debt it ran up is kept.
+        if (deficit > 0 && slot.pending.load(std::memory_order_relaxed) == 0) {
+            slot.deficit.store(0, std::memory_order_relaxed);
+            return true;
+        }
+        return deficit <= 0;
+    }
+
+    /**
+     * @brief Ends the handling of events taken from a slot.
+     * @param slot The slot the events were taken from.
+     * @param count The number of events taken.
+     */
+    void release(Slot& slot, std::size_t count = 1) {
+        if (options.ordering != SlotOrdering::Serial) {
+            return;
+        }
+        slot.owned.store(false, std::memory_order_release);
+        if (slot.pending.fetch_sub(count) != count) {
+            slots.ready().mark(slot.index);
+            eventCount.wakeOne();
+        }
+    }
+
+    /**
+     * @brief Pops more events from a slot the caller just claimed one from.
+     * @param slot The claimed slot.
+     * @param[out] events Receives the events.
+     * @param maxCount The maximum number of events to pop.
+     * @param consumer The consumer's token, or nullptr.
+     * @return The number of events popped.
+     */
+    std::size_t claimMore(Slot& slot, Stored* events, std::size_t maxCount,
+                          ConsumerToken* consumer) {
+        std::size_t count = 0;
+        if constexpr (TokenBulkQueueConcept<StoredQueue>) {
+            if (consumer != nullptr) {
+                auto& token = consumer->tokens.at(
+                    slot.index, [&slot] { return slot.queue.consumerToken(); });
+                count = slot.queue.pop_bulk(token, events, maxCount);
+            } else {
+                count = slot.queue.pop_bulk(events, maxCount);
+            }
+        } else if constexpr (BulkQueueConcept<StoredQueue>) {
+            count = slot.queue.pop_bulk(events, maxCount);
+        } else {
+            while (count < maxCount &&
+                   popEvent(slot, events[count], consumer)) {
+                ++count;
+            }
+        }
+        // A serial slot stays owned; release() settles its count.
+        if (count != 0 && options.ordering != SlotOrdering::Serial &&
+            slot.pending.fetch_sub(count) == count) {
+            markIdle(slot);
+        }
+        return count;
+    }
+
+    /**
+     * @brief Processes up to options.burst events of the next type in
+     * round-robin order.
+     * @param[in,out] position The round-robin cursor.
+     * @param maxEvents The maximum number of events to take.
+     * @param consumer The consumer's token, or nullptr.
+     * @return The number of events handled.
+     */
+    std::size_t processBurst(std::size_t& position, std::size_t maxEvents,
+                             ConsumerToken* consumer) {
+        std::array<Stored, SchedulingOptions::maxBurst> events;
+        auto* slot = claim(position, events[0], consumer);
+        if (slot == nullptr) {
+            return 0;
+        }
+        auto limit = std::min({options.burst, maxEvents, events.size()});
+        auto taken = 1 + claimMore(*slot, &events[1], limit - 1, consumer);
+
+        std::size_t handled = 0;
+        for (std::size_t i = 0; i < taken; ++i) {
+            if (expired(events[i])) {
+                slot->dropped.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            slot->handlers.invoke(events[i].event);
+            ++handled;
+        }
+        release(*slot, taken);
+        return handled;
+    }
+
+    /**
+     * @brief Processes the next event, or the next burst when bursts are
+     * enabled.
+     * @tparam Cursor Either nothing, to use the shared cursor,
+     * DispatchCursor or ConsumerToken.
+     * @param maxEvents The maximum number of events to take.
+     * @param cursor Optionally, the consumer's own cursor.
+     * @return The number of events handled; 0 if there were none.
+     */
+    template <typename... Cursor>
+    std::size_t processSome(std::size_t maxEvents, Cursor&... cursor) {
+        if (options.burst <= 1 || options.fairness != Fairness::RoundRobin) {
+            return processOne(cursor...) ? 1 : 0;
+        }
+        if constexpr (sizeof...(Cursor) == 0) {
+            auto position = currentIndex.load(std::memory_order_relaxed);
+            auto handled = processBurst(position, maxEvents, nullptr);
+            currentIndex.store(position, std::memory_order_relaxed);
+            return handled;
+        } else {
+            return processBurst(cursor.position..., maxEvents,
+                                consumerOf(cursor...));
+        }
+    }
+
+    /** @brief A plain cursor has no tokens. */
+    static ConsumerToken* consumerOf(DispatchCursor& /*cursor*/) {
+        return nullptr;
+    }
+
+    /** @brief The tokens of a consumer token. */
+    static ConsumerToken* consumerOf(ConsumerToken& consumer) {
+        return &consumer;
+    }
+
+    /**
+     * @brief Process one event at a consumer's own cursor.
+     * @param[in,out] position The consumer's cursor.
+     * @param consumer The consumer's token, or nullptr.
+     * @return true if an event was processed, false otherwise.
+     */
+    bool processAt(std::size_t& position, ConsumerToken* consumer) {
+        Stored event;
+        auto* slot = claim(position, event, consumer);
+        if (slot == nullptr) {
+            return false;
+        }
+        if (run(*slot, event.event)) {
+            position = slot->index + 1;
         }
-        return iter->second;
+        return true;
     }
 
    public:
+    using key_type = EventType;  ///< The type used to identify events.
+
+    /** @brief The cursor a consumer keeps for this queue. */
+    using Cursor = DispatchCursor;
+
+    /**
+     * @brief Constructs a queue that handles events concurrently, in plain
+     * round-robin order.
+     */
+    BasicSpecialEventQueue() = default;
+
+    /**
+     * @brief Constructs a queue with the given ordering of each type.
+     *
+     * With SlotOrdering::Serial, events of one type are handled one at a time
+     * and in the order their queue yields them, however many consumers there
+     * are; different types are still handled in parallel.
+     *
+     * @param ordering Whether an event type may run on several consumers.
+     */
+    explicit BasicSpecialEventQueue(SlotOrdering ordering)
+        : BasicSpecialEventQueue(SchedulingOptions{ordering}) {}
+
+    /**
+     * @brief Constructs a queue with the given scheduling options.
+     *
+     * With one of the deficit fairness modes each event type gets a share of
+     * dispatch proportional to its weight (see setWeight()), counted either
+     * in events or in handler time. With several consumers the accounting is
+     * shared and therefore approximate.
+     *
+     * @param options Ordering and fairness of the queue.
+     */
+    explicit BasicSpecialEventQueue(SchedulingOptions options)
+        : options(options) {}
+
     /**
      * @brief Enqueue an event of a specific type.
+     *
+     * If the type's queue is bounded and full, the type's overflow policy
+     * decides what happens, see setOverflowPolicy().
+     *
+     * @tparam T The type of the event to enqueue.
+     * @param type The event type.
+     * @param event The event to enqueue.
+     * @return Whether the event was queued; always Enqueued unless the queue
+     * is bounded.
+     */
+    template <typename T>
+    EnqueueStatus enqueue(const EventType& type, T&& event) {
+        return enqueue(type, std::forward<T>(event), EventDeadline::max());
+    }
+
+    /**
+     * @brief Enqueue an event that is dropped if it is not dispatched by a
+     * deadline.
+     *
+     * An expired event is counted in droppedEvents() and never reaches the
+     * handlers, whichever fairness mode is in use.
+     *
+     * @tparam T The type of the event to enqueue.
+     * @param type The event type.
+     * @param event The event to enqueue.
+     * @param deadline The latest time the event may be dispatched at;
+     * EventDeadline::max() for none.
+     * @return Whether the event was queued.
+     */
+    template <typename T>
+    EnqueueStatus enqueue(const EventType& type, T&& event,
+                          EventDeadline deadline) {
+        return pushEvent(slots.getOrCreate(type), nullptr,
+                         Stored{Event(std::forward<T>(event)), deadline});
+    }
+
+    /**
+     * @brief Opens a channel for an event type, creating its slot if needed.
+     *
+     * Producers that emit the same types over and over can keep a channel
+     * per type and skip the type lookup of enqueue() on every event.
+     *
+     * @param type The event type.
+     * @return The channel of the type.
+     */
+    Channel channel(const EventType& type) {
+        return Channel(*this, slots.getOrCreate(type));
+    }
+
+    /**
+     * @brief Creates a token for a single producer thread.
+     *
+     * With a queue that supports tokens, such as MoodycamelQueue, events
+     * enqueued through the token go to the producer's own sub-queue of each
+     * type without a thread-local lookup. Otherwise the token has no effect.
+     * A token must only be used with the queue that made it, by one thread
+     * at a time.
+     *
+     * @return A new producer token.
+     */
+    ProducerToken producerToken() { return ProducerToken{}; }
+
+    /**
+     * @brief Creates a token for a single consumer thread.
+     *
+     * The token is also the consumer's round-robin cursor, see
+     * processOne(ConsumerToken&).
+     *
+     * @return A new consumer token.
+     */
+    ConsumerToken consumerToken() { return ConsumerToken{}; }
+
+    /**
+     * @brief Enqueue an event through a producer's token.
      * @tparam T The type of the event to enqueue.
+     * @param producer The producer's token, made by this queue.
      * @param type The event type.
      * @param event The event to enqueue.
+     * @param deadline The latest time the event may be dispatched at;
+     * EventDeadline::max() for none.
+     * @return Whether the event was queued.
      */
     template <typename T>
-    void enqueue(const EventType& type, T&& event) {
-        getQueue(type).push(std::forward<T>(event));
+    EnqueueStatus enqueue(ProducerToken& producer, const EventType& type,
+                          T&& event,
+                          EventDeadline deadline = EventDeadline::max()) {
+        return pushEvent(slots.getOrCreate(type), &producer,
+                         Stored{Event(std::forward<T>(event)), deadline});
+    }
+
+    /**
+     * @brief Enqueue an event that is dropped if it waits longer than a
+     * time to live.
+     * @tparam T The type of the event to enqueue.
+     * @param type The event type.
+     * @param event The event to enqueue.
+     * @param ttl How long the event may wait to be dispatched.
+     * @return Whether the event was queued.
+     */
+    template <typename T, typename Rep, typename Period>
+    EnqueueStatus enqueue(const EventType& type, T&& event,
+                          const std::chrono::duration<Rep, Period>& ttl) {
+        return enqueue(type, std::forward<T>(event),
+                       std::chrono::steady_clock::now() +
+                           std::chrono::duration_cast<
+                               std::chrono::steady_clock::duration>(ttl));
+    }
+
+    /**
+     * @brief Enqueue a range of events of one type.
+     *
+     * The pending count and ready bit are updated once for the whole range,
+     * and queues that support it receive the range in a single push_bulk().
+     * A bounded queue whose type does not block on overflow takes the events
+     * one at a time instead, each under the overflow policy.
+     *
+     * @tparam It A forward iterator over the events, or a move_iterator over
+     * one to move the events into the queue.
+     * @param type The event type.
+     * @param first The first event.
+     * @param last One past the last event.
+     * @return The number of events queued.
+     */
+    template <typename It>
+        requires std::derived_from<
+            typename std::iterator_traits<It>::iterator_category,
+            std::forward_iterator_tag>
+    std::size_t enqueueBulk(const EventType& type, It first, It last) {
+        if (first == last) {
+            return 0;
+        }
+        return pushRange(slots.getOrCreate(type), nullptr, first, last);
+    }
+
+    /**
+     * @brief Enqueue a range of events of one type through a producer's
+     * token, see enqueueBulk().
+     * @tparam It A forward iterator over the events.
+     * @param producer The producer's token, made by this queue.
+     * @param type The event type.
+     * @param first The first event.
+     * @param last One past the last event.
+     * @return The number of events queued.
+     */
+    template <typename It>
+        requires std::derived_from<
+            typename std::iterator_traits<It>::iterator_category,
+            std::forward_iterator_tag>
+    std::size_t enqueueBulk(ProducerToken& producer, const EventType& type,
+                            It first, It last) {
+        if (first == last) {
+            return 0;
+        }
+        return pushRange(slots.getOrCreate(type), &producer, first, last);
     }
 
     /**
@@ -131,40 +1360,202 @@ class SpecialEventQueue {
      * burst of events of one type does not cause events of other types to
      * starve.
      *
-     * @warning Assumes 'queues' and 'handlers' never delete an entry.
+     * Event types without pending events are skipped using the ready bitmap,
+     * so a call only comes back empty-handed when there is nothing to do or
+     * every ready event is still being pushed by its producer.
+     *
+     * This overload advances a round-robin cursor shared by every consumer.
+     *
+     * @warning Assumes slots are never deleted while the queue is alive.
      *
-     * @note This function may not always process an event in a single call.
-     * It uses a round-robin method to select the target queue, and if that
-     * queue is empty, it returns without checking subsequent queues. This
-     * design choice was made to maintain code simplicity, as this method is
-     * typically called in a loop within a thread. Occasional non-processing
-     * iterations do not significantly impact overall performance and are
-     * expected as part of normal operation.
+     * @return true if an event was processed, false otherwise.
      */
-    void processOne() {
-        auto eventTypeCount = eventTypes.size();
-        if (eventTypeCount == 0) {
-            return;
+    bool processOne() {
+        Stored event;
+        auto position = currentIndex.load(std::memory_order_relaxed);
+        auto* slot = claim(position, event, nullptr);
+        currentIndex.store(position, std::memory_order_relaxed);
+        if (slot == nullptr) {
+            return false;
         }
+        if (run(*slot, event.event) && position == slot->index) {
+            // Move on only if no other consumer moved the cursor meanwhile.
+            currentIndex.compare_exchange_strong(position, slot->index + 1,
+                                                 std::memory_order_relaxed);
+        }
+        return true;
+    }
 
-        auto index = currentIndex.fetch_add(1, std::memory_order_relaxed) %
-                     eventTypeCount;
+    /**
+     * @brief Process one event, advancing the caller's own round-robin cursor.
+     *
+     * Behaves like processOne(), but consumers that each own a cursor do not
+     * contend on the shared one. Every consumer is fair on its own, so a pool
+     * of them is fair as a whole.
+     *
+     * @param cursor The consumer's cursor.
+     * @return true if an event was processed, false otherwise.
+     */
+    bool processOne(DispatchCursor& cursor) {
+        return processAt(cursor.position, nullptr);
+    }
 
-        auto eventType = eventTypes[index];
+    /**
+     * @brief Process one event, advancing the consumer's cursor and popping
+     * with its own queue tokens.
+     * @param consumer The consumer's token.
+     * @return true if an event was processed, false otherwise.
+     */
+    bool processOne(ConsumerToken& consumer) {
+        return processAt(consumer.position, &consumer);
+    }
 
-        auto queueIter = queues.find(eventType);
-        if (queueIter != queues.end()) {
-            typename QueueType::value_type event;
-            if (queueIter->second.pop(event)) {
-                auto range = handlers.equal_range(eventType);
-                for (auto handlerIt = range.first; handlerIt != range.second;
-                     ++handlerIt) {
-                    std::invoke(handlerIt->second, event);
-                }
+    /**
+     * @brief Process events until the queues are empty or a count is reached.
+     *
+     * Events are taken in the same fair round-robin order as processOne(),
+     * or, with a burst size set, up to that many per type and turn.
+     *
+     * @tparam Cursor Either nothing, to use the shared cursor,
+     * DispatchCursor or ConsumerToken.
+     * @param maxEvents The maximum number of events to process.
+     * @param cursor Optionally, the consumer's own cursor.
+     * @return The number of events processed.
+     */
+    template <typename... Cursor>
+        requires(sizeof...(Cursor) <= 1)
+    std::size_t processBatch(std::size_t maxEvents, Cursor&... cursor) {
+        return drainEvents(maxEvents, [&](std::size_t allowed) {
+            return processSome(allowed, cursor...);
+        });
+    }
+
+    /**
+     * @brief Process events until the queues are empty or a budget runs out.
+     *
+     * Events are taken in the same fair round-robin order as processOne(),
+     * or, with a burst size set, up to that many per type and turn.
+     * The time budget is checked after each event, so a slow handler can
+     * overrun it by at most its own duration.
+     *
+     * @tparam Cursor Either nothing, to use the shared cursor,
+     * DispatchCursor or ConsumerToken.
+     * @param budget The maximum time to spend processing.
+     * @param maxEvents The maximum number of events to process.
+     * @param cursor Optionally, the consumer's own cursor.
+     * @return The number of events processed.
+     */
+    template <typename Rep, typename Period, typename... Cursor>
+        requires(sizeof...(Cursor) <= 1)
+    std::size_t processFor(
+        const std::chrono::duration<Rep, Period>& budget,
+        std::size_t maxEvents = std::numeric_limits<std::size_t>::max(),
+        Cursor&... cursor) {
+        return drainEventsFor(budget, maxEvents, [&](std::size_t allowed) {
+            return processSome(allowed, cursor...);
+        });
+    }
+
+    /**
+     * @brief Approximate number of events waiting to be processed.
+     *
+     * Sums the per-type counters without stopping producers or consumers, so
+     * the result is a snapshot meant for monitoring and scaling decisions. In
+     * serial mode, events whose handlers are running are included.
+     *
+     * @return The number of pending events.
+     */
+    std::size_t pendingEvents() {
+        std::size_t total = 0;
+        auto eventTypeCount = slots.size();
+        for (std::size_t index = 0; index < eventTypeCount; ++index) {
+            total += slots[index].pending.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Sets what enqueueing an event of a type does while the type's
+     * queue is full.
+     *
+     * Only bounded queues, such as BoundedMpmcQueue, are ever full; the
+     * default is OverflowPolicy::Block. OverflowPolicy::DropOldest makes the
+     * producer pop, so it is refused for queues with a single consumer, such
+     * as SpscRingQueue.
+     *
+     * @param type The event type.
+     * @param policy The overflow policy.
+     * @return false if the policy was refused and the previous one kept.
+     */
+    bool setOverflowPolicy(const EventType& type, OverflowPolicy policy) {
+        auto& slot = slots.getOrCreate(type);
+        if constexpr (SingleConsumerQueueConcept<StoredQueue>) {
+            if (policy == OverflowPolicy::DropOldest &&
+                slot.queue.single_consumer()) {
+                return false;
             }
         }
+        slot.overflow.store(static_cast<std::uint8_t>(policy),
+                            std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Number of events of a type that were dropped, either because
+     * they expired before dispatch or by the type's overflow policy.
+     * @param type The event type.
+     * @return The number of dropped events.
+     */
+    std::uint64_t droppedEvents(const EventType& type) {
+        auto* slot = slots.find(type);
+        return slot != nullptr
+                   ? slot->dropped.load(std::memory_order_relaxed)
+                   : 0;
+    }
+
+    /**
+     * @brief Number of events of every type that were dropped, see
+     * droppedEvents(const EventType&).
+     * @return The number of dropped events.
+     */
+    std::uint64_t droppedEvents() {
+        std::uint64_t total = 0;
+        auto eventTypeCount = slots.size();
+        for (std::size_t index = 0; index < eventTypeCount; ++index) {
+            total += slots[index].dropped.load(std::memory_order_relaxed);
+        }
+        return total;
     }
 
+    /**
+     * @brief Checks whether any event type has pending events.
+     * @return true if at least one event may be waiting to be processed.
+     */
+    bool hasPendingEvents() { return slots.ready().any(slots.size()); }
+
+    /**
+     * @brief Blocks the calling consumer until there may be events to process.
+     *
+     * The consumer parks on an EventCount and checks the ready bitmap once
+     * more before sleeping. Producers only pay for a wakeup while a consumer
+     * is parked, and each enqueue wakes at most one consumer.
+     *
+     * @tparam Predicate A callable returning true when the wait should end
+     * regardless of pending events, e.g. on shutdown.
+     * @param shouldStop The stop condition. Whoever makes it true must call
+     * notifyAll() afterwards.
+     */
+    template <typename Predicate>
+    void waitForEvents(Predicate&& shouldStop) {
+        eventCount.wait([this] { return hasPendingEvents(); },
+                        std::forward<Predicate>(shouldStop));
+    }
+
+    /**
+     * @brief Wakes every consumer blocked in waitForEvents().
+     */
+    void notifyAll() { eventCount.wakeAll(); }
+
     /**
      * @brief Add a new event handler for a specific event type.
      * @tparam H The type of the handler function.
@@ -173,8 +1564,85 @@ class SpecialEventQueue {
      */
     template <typename H>
     void appendListener(const EventType& type, H&& handler) {
-        handlers.emplace(type, std::forward<H>(handler));
+        slots.getOrCreate(type).handlers.append(std::forward<H>(handler));
     }
+
+    /**
+     * @brief Sets the share of an event type under deficit round robin.
+     *
+     * A type with weight 2 is granted twice the events, or twice the handler
+     * time, of a type with weight 1 while both have events pending. Has no
+     * effect with Fairness::RoundRobin.
+     *
+     * @param type The event type.
+     * @param weight The relative share, at least 1.
+     */
+    void setWeight(const EventType& type, std::uint32_t weight) {
+        slots.getOrCreate(type).weight.store(std::max<std::uint32_t>(weight, 1),
+                                             std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Invokes the handlers of an event type right away, bypassing the
+     * queue.
+     * @tparam T The type of the event.
+     * @param type The event type.
+     * @param event The event passed to each handler.
+     */
+    template <typename T>
+    void dispatch(const EventType& type, const T& event) {
+        slots.getOrCreate(type).handlers.invoke(event);
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @class SpecialEventQueue
+ * @brief A thread-safe event queue system supporting multiple event types and
+ * handlers.
+ *
+ * @tparam EventType The type used to identify different events.
+ * @tparam HandlerType The type of the event handlers.
+ * @tparam QueueType The type of queue used to store events. It is a template
+ * of the event type, instantiated once more to keep each event's deadline.
+ *
+ * This generic version accepts any hashable event type and keeps its per-type
+ * state in TBB concurrent containers.
+ */
+template <typename EventType, typename HandlerType, typename QueueType>
+    requires HashableConcept<EventType> && DefaultConstructible<QueueType> &&
+             QueueConcept<QueueType> &&
+             RebindableQueueConcept<QueueType> &&
+             HandlerConcept<HandlerType, QueueType>
+class SpecialEventQueue
+    : public detail::BasicSpecialEventQueue<EventType, HandlerType, QueueType,
+                                            detail::HashedSlotIndex> {
+    using detail::BasicSpecialEventQueue<
+        EventType, HandlerType, QueueType,
+        detail::HashedSlotIndex>::BasicSpecialEventQueue;
+};
+
+/**
+ * @class SpecialEventQueue
+ * @brief Specialization for event types that are small enumerations.
+ *
+ * Queues, handler lists and the round-robin order are kept in flat arrays
+ * indexed by the enumeration value, which takes hashing off the enqueue and
+ * dispatch paths.
+ */
+template <typename EventType, typename HandlerType, typename QueueType>
+    requires HashableConcept<EventType> && DefaultConstructible<QueueType> &&
+             QueueConcept<QueueType> &&
+             RebindableQueueConcept<QueueType> &&
+             HandlerConcept<HandlerType, QueueType> &&
+             DenseEnumConcept<EventType>
+class SpecialEventQueue<EventType, HandlerType, QueueType>
+    : public detail::BasicSpecialEventQueue<EventType, HandlerType, QueueType,
+                                            detail::DenseSlotIndex> {
+    using detail::BasicSpecialEventQueue<
+        EventType, HandlerType, QueueType,
+        detail::DenseSlotIndex>::BasicSpecialEventQueue;
 };
 }  // namespace eventTree::eventHubs
 #endif
\ No newline at end of file
@@ -1,18 +1,76 @@
 #ifndef SPECIAL_HUB_H
 #define SPECIAL_HUB_H
 
+#include <array>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <type_traits>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
 
+#include "DispatchOptions.h"
 #include "IEventHub.h"
+#include "IdleStrategy.h"
+#include "ScalingPolicy.h"
+#include "SpecialEventQueue/PriorityEventQueue.h"
+#include "SpecialEventQueue/ProducerFairEventQueue.h"
 #include "SpecialEventQueue/Queues/MoodycamelQueue.h"  // NOLINT
 #include "SpecialEventQueue/Queues/NaiveQeue.h"        // NOLINT
 #include "SpecialEventQueue/SpecialEventQueue.h"
+#include "ThreadPlacement.h"
+#include "ValueChannel.h"
 #include "events/Event.h"
 
 namespace eventTree::eventHubs {
 
+/**
+ * @struct PinnedWorker
+ * @brief A dispatch thread dedicated to a fixed set of event types.
+ *
+ * Events of the listed types are queued separately and only ever handled by
+ * this thread, so each type is processed in order on one core and its handler
+ * state stays in that core's caches.
+ */
+struct PinnedWorker {
+    std::vector<events::EventType> types; /**< Types owned by this worker. */
+    ThreadPlacement placement; /**< CPU and scheduling class of the thread. */
+};
+
+/**
+ * @struct StrandOptions
+ * @brief Serializes the shared pool's events by a user-defined key.
+ *
+ * Events whose keys fall on the same strand are handled one at a time and in
+ * the order each producer emitted them, while different strands are handled
+ * in parallel by the workers. Keys are spread over a fixed number of strands,
+ * so two distinct keys may share one and be serialized together.
+ *
+ * Ordering comes at the cost of the shared pool's other guarantees: with
+ * strands enabled the workers go round robin over strand indices, so
+ * priorities, per-producer fairness and per-type fairness no longer apply to
+ * the shared pool's events. A producer flooding a strand delays the other
+ * events on that strand, and a busy strand gets no larger share than an idle
+ * one. Pinned types are unaffected.
+ */
+struct StrandOptions {
+    /**
+     * @brief Extracts the ordering key of an event, e.g. a hash of its
+     * target land. Strands are disabled while this is empty.
+     */
+    std::function<std::size_t(events::EventType, const events::EventPtr&)>
+        key;
+
+    /** @brief Number of strands the keys are spread over. */
+    std::size_t strands = 64;  // NOLINT
+};
+
 /**
  * @class SpecialHub
  * @brief A concrete implementation of IEventHub using the custom-made
@@ -20,40 +78,199 @@ namespace eventTree::eventHubs {
  *
  * SpecialHub provides an event handling mechanism using an event queue from the
  * SpecialEventQueue library. It allows for emitting events and registering
- * event handlers.
+ * event handlers. Events are dispatched by a pool of worker threads, each
+ * with its own round-robin cursor: by priority first, then fairly across
+ * producers and finally across event types. Optionally, a supervisor thread
+ * grows and shrinks the pool with the backlog, event types can be pinned to
+ * dedicated threads that bypass the shared pool, and the shared pool can keep
+ * events with the same key in order through strands.
  */
 class SpecialHub : public IEventHub {
    private:
     /** @brief Type alias for the event queue used internally. */
     using EventQueue =
-        SpecialEventQueue<events::EventType,
-                          std::function<void(events::EventPtr)>,
+        SpecialEventQueue<events::EventType, EventHandler,
                           queues::MoodycamelQueue<events::EventPtr> >;
 
-    EventQueue queue; /**< The event queue for storing and processing events. */
-    std::thread dispatch_thread;     /**< Thread for dispatching events. */
+    /** @brief A priority lane of the shared pool, with a lane per producer. */
+    using ProducerQueue =
+        ProducerFairEventQueue<ProducerId, events::EventType, EventHandler,
+                               queues::MoodycamelQueue<events::EventPtr> >;
+
+    /** @brief The shared pool's queue, with a lane per Priority. */
+    using SharedQueue = PriorityEventQueue<ProducerQueue, 3>;
+
+    /**
+     * @struct StrandedEvent
+     * @brief An event waiting on its strand, with the type it was emitted as.
+     */
+    struct StrandedEvent {
+        events::EventType type{}; /**< The type it was emitted as. */
+        events::EventPtr event;   /**< The event itself. */
+    };
+
+    /** @brief Queue of the strands, with one serial slot per strand. */
+    using StrandQueue =
+        SpecialEventQueue<std::size_t,
+                          std::function<void(const StrandedEvent&)>,
+                          queues::MoodycamelQueue<StrandedEvent> >;
+
+    /** @brief Emits through a producer's tokens, see openEmitHandle(). */
+    class ProducerHandle;
+
+    /**
+     * @struct Worker
+     * @brief State owned by a single dispatch thread.
+     */
+    struct Worker {
+        /**
+         * @brief Constructs a worker that is not running yet.
+         * @param idle Settings of the worker's idle strategy.
+         * @param placement CPU and scheduling class of the worker's thread.
+         */
+        Worker(const IdleOptions& idle, const ThreadPlacement& placement)
+            : idleStrategy(idle), placement(placement) {}
+
+        DispatchCursor cursor;                   /**< Round-robin position. */
+        SharedQueue::Cursor laneCursors; /**< Positions in shared lanes. */
+        IdleStrategy idleStrategy;               /**< Waits when idle. */
+        std::atomic<bool> retiring{false};       /**< Asks it to stop. */
+        std::atomic<std::uint64_t> processed{0}; /**< Events processed. */
+        ThreadPlacement placement;               /**< Where it runs. */
+        std::thread thread;                      /**< Dispatch thread. */
+    };
+
+    /** @brief Number of distinct values of events::EventType. */
+    static constexpr std::size_t eventTypeCount =
+        std::size_t{std::numeric_limits<
+            std::underlying_type_t<events::EventType>>::max()} +
+        1;
+
+    SharedQueue queue; /**< The queue for storing and processing events. */
+    DispatchOptions options;         /**< Settings of the dispatch loop. */
     std::atomic<bool> running{true}; /**< Flag to control the dispatch loop. */
 
+    /** @brief Guards the pool and its statistics. */
+    mutable std::mutex workersMutex;
+    std::vector<std::unique_ptr<Worker>> workers; /**< Dispatch threads. */
+    IdleStats retiredIdleStats;         /**< Stats of retired workers. */
+    std::uint64_t retiredProcessed = 0; /**< Events of retired workers. */
+    ScalingStats scaling;               /**< Scaling decisions so far. */
+
+    std::thread supervisor; /**< Scales the pool, if elastic. */
+
+    /** @brief Queues of pinned types; fixed after construction. */
+    std::vector<std::unique_ptr<EventQueue>> pinnedQueues;
+    std::vector<std::unique_ptr<Worker>> pinnedWorkers; /**< Their threads. */
+
+    /** @brief Queue of each event type; nullptr means the shared queue. */
+    std::array<EventQueue*, eventTypeCount> routes{};
+
+    StrandOptions strandOptions; /**< How shared events map to strands. */
+
+    /**
+     * @brief Consumed by the shared pool instead of `queue` when strands are
+     * enabled; `queue` then only holds the handlers.
+     */
+    std::unique_ptr<StrandQueue> strandQueue;
+
+    /** @brief Queue of each event class with a ValueChannel. */
+    std::unordered_map<std::type_index,
+                       std::unique_ptr<detail::ValueQueueBase>>
+        valueQueues;
+    std::vector<std::unique_ptr<Worker>> valueWorkers; /**< Their threads. */
+
+    /**
+     * @brief Finds the pinned queue of an event type.
+     * @param type The event type.
+     * @return The type's pinned queue, or nullptr if it uses the shared one.
+     */
+    EventQueue* pinnedQueueFor(events::EventType type);
+
+    /**
+     * @brief Finds the queue of an event class with a ValueChannel, creating
+     * it and its dispatch threads the first time.
+     * @param type The event class.
+     * @param channelOptions The dispatch threads to start with the queue.
+     * @param make Creates the queue.
+     * @return The class's queue.
+     */
+    detail::ValueQueueBase& valueQueueFor(
+        std::type_index type, const ChannelOptions& channelOptions,
+        const std::function<std::unique_ptr<detail::ValueQueueBase>()>& make);
+
     /**
      * @brief Private method to dispatch events from the queue.
      *
      * This method runs in a separate thread and continuously processes events
      * from the queue.
+     *
+     * @tparam Queue The type of the queue: EventQueue, SharedQueue or
+     * StrandQueue.
+     * @param worker The state of the calling worker.
+     * @param queue The queue the worker consumes.
+     */
+    template <typename Queue>
+    void dispatchEvents(Worker& worker, Queue& queue);
+
+    /**
+     * @brief Creates a worker and starts its dispatch thread.
+     *
+     * Must be called with workersMutex held, or before other threads exist.
      */
-    void dispatchEvents();
+    void startWorker();
+
+    /**
+     * @brief Asks the most recently started worker to stop and takes it out
+     * of the pool.
+     *
+     * Must be called with workersMutex held.
+     *
+     * @return The worker, to be passed to retireWorker().
+     */
+    std::unique_ptr<Worker> detachWorker();
+
+    /**
+     * @brief Joins a detached worker and adds its statistics to those of the
+     * retired workers.
+     *
+     * Must be called without workersMutex held, so that a long-running
+     * handler of the worker does not block the hub's other users.
+     *
+     * @param worker The worker returned by detachWorker().
+     */
+    void retireWorker(std::unique_ptr<Worker> worker);
+
+    /**
+     * @brief Periodically samples the backlog and resizes the pool.
+     *
+     * Runs in the supervisor thread when elastic scaling is enabled.
+     */
+    void superviseWorkers();
 
    public:
     /**
-     * @brief Default constructor.
+     * @brief Constructor.
+     *
+     * Initializes the event queues and starts the dispatch threads.
      *
-     * Initializes the event queue and starts the dispatch thread.
+     * @param options Settings of the shared dispatch loop.
+     * @param pinned Dedicated threads and the event types they own. Types
+     * that are not listed are dispatched by the shared pool. A type listed
+     * more than once belongs to its first worker.
+     * @throws std::invalid_argument if a pinned worker would own no type,
+     * because its list is empty or every type in it belongs to an earlier
+     * worker.
+     * @param strands Per-key ordering of the shared pool's events.
      */
-    SpecialHub();
+    explicit SpecialHub(DispatchOptions options = {},
+                        const std::vector<PinnedWorker>& pinned = {},
+                        StrandOptions strands = {});
 
     /**
      * @brief Destructor.
      *
-     * Stops the dispatch thread and cleans up resources.
+     * Stops the dispatch threads and cleans up resources.
      */
     ~SpecialHub() override;
 
@@ -64,13 +281,104 @@ class SpecialHub : public IEventHub {
      */
     void emitEvent(events::EventType type, events::EventPtr event) override;
 
+    /**
+     * @brief Emits an event on behalf of a producer.
+     *
+     * Each producer's events wait in their own lane, so a producer flooding
+     * the hub cannot starve another one, even on the same event type.
+     * Pinned types and strands keep their own ordering and ignore the
+     * producer.
+     *
+     * @param producer The producer emitting the event.
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     */
+    void emitEvent(ProducerId producer, events::EventType type,
+                   events::EventPtr event) override;
+
+    /**
+     * @brief Emits an event with a priority.
+     *
+     * More urgent events are always handled first, subject to
+     * DispatchOptions::priorityAging. Pinned types and strands ignore the
+     * priority.
+     *
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     * @param priority How urgently the event must be handled.
+     */
+    void emitEvent(events::EventType type, events::EventPtr event,
+                   Priority priority) override;
+
+    /**
+     * @brief Emits an event with a priority on behalf of a producer.
+     * @param producer The producer emitting the event.
+     * @param type The type of event to handle.
+     * @param event Shared pointer to the event to be emitted.
+     * @param priority How urgently the event must be handled.
+     */
+    void emitEvent(ProducerId producer, events::EventType type,
+                   events::EventPtr event, Priority priority) override;
+
+    /**
+     * @brief Opens a handle that emits events on behalf of a producer.
+     *
+     * The handle keeps the producer's lane of each priority and its queue
+     * tokens, so its events skip the lane lookup and go to the producer's
+     * own sub-queues. It also keeps a channel per pinned type, so those
+     * events go straight to their pinned queue. Strands are routed as by
+     * emitEvent().
+     *
+     * @param producer The producer emitting through the handle.
+     * @return The handle.
+     */
+    std::unique_ptr<EmitHandle> openEmitHandle(ProducerId producer) override;
+
+    /** @brief The overload for handlers of the event itself. */
+    using IEventHub::registerHandler;
+
     /**
      * @brief Registers a handler function for a specific event type.
      * @param type The type of event to handle.
      * @param func The handler function to be called when the event occurs.
      */
-    void registerHandler(events::EventType type,
-                         std::function<void(events::EventPtr)> func) override;
+    void registerHandler(events::EventType type, EventHandler func) override;
+
+    /**
+     * @brief Opens the typed channel of an event class.
+     *
+     * Events emitted through the channel are stored by value and handed to
+     * the channel's handlers as `const T&`. Each event class gets a queue and
+     * dispatch threads of its own, like a pinned type, the first time its
+     * channel is opened. The EventPtr path of emitEvent() and
+     * registerHandler() is unaffected.
+     *
+     * @tparam T The event class.
+     * @param channelOptions The number and placement of the channel's
+     * threads. Only the first call for a class starts threads; later calls
+     * ignore it. No threads are started once the hub is being destroyed.
+     * @return The channel; every call returns one for the same queue.
+     */
+    template <ValueEventConcept T>
+    ValueChannel<T> channel(const ChannelOptions& channelOptions = {}) {
+        auto& valueQueue = valueQueueFor(typeid(T), channelOptions, [] {
+            return std::make_unique<detail::ValueQueue<T>>();
+        });
+        return ValueChannel<T>(static_cast<detail::ValueQueue<T>&>(valueQueue));
+    }
+
+    /**
+     * @brief Statistics of the dispatch threads' idle strategies.
+     * @return The number of empty polls and the time spent idling, summed
+     * over all workers.
+     */
+    [[nodiscard]] IdleStats idleStats() const;
+
+    /**
+     * @brief Scaling decisions of the worker pool.
+     * @return The current pool size and how often it grew and shrank.
+     */
+    [[nodiscard]] ScalingStats scalingStats() const;
 
     // Special constructors to comply with "rule of 5"
     SpecialHub(const SpecialHub&) = delete;
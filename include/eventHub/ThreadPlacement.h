@@ -0,0 +1,96 @@
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <cstdint>
+#include <optional>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace eventTree::eventHubs {
+
+/**
+ * @enum SchedulingClass
+ * @brief Operating system scheduling policy of a dispatch thread.
+ */
+enum class SchedulingClass : std::uint8_t {
+    Default,    /**< Leave the thread's policy unchanged. */
+    Normal,     /**< Time-shared scheduling (SCHED_OTHER). */
+    Batch,      /**< Throughput-oriented time sharing (SCHED_BATCH). */
+    Idle,       /**< Runs only when nothing else wants the CPU (SCHED_IDLE). */
+    Fifo,       /**< Real-time, first in first out (SCHED_FIFO). */
+    RoundRobin  /**< Real-time with time slices (SCHED_RR). */
+};
+
+/**
+ * @struct ThreadPlacement
+ * @brief Where and how a dispatch thread runs.
+ *
+ * Placement is a request to the operating system. Real-time classes usually
+ * need extra privileges; when a setting is refused, or the platform has no
+ * support for it, the thread keeps running with its default settings.
+ */
+struct ThreadPlacement {
+    /** @brief CPU to pin the thread to, or std::nullopt to let it float. */
+    std::optional<unsigned> cpu;
+
+    /** @brief Scheduling policy of the thread. */
+    SchedulingClass schedulingClass = SchedulingClass::Default;
+
+    /** @brief Priority within the real-time classes, ignored otherwise. */
+    int priority = 0;
+};
+
+/**
+ * @brief Applies a placement to the calling thread.
+ * @param placement The CPU and scheduling settings to apply.
+ * @return true if every requested setting was applied.
+ */
+inline bool applyToCurrentThread(const ThreadPlacement& placement) {
+#if defined(__linux__)
+    bool applied = true;
+    auto self = pthread_self();
+
+    if (placement.cpu) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(*placement.cpu, &cpus);
+        applied &= pthread_setaffinity_np(self, sizeof(cpus), &cpus) == 0;
+    }
+
+    if (placement.schedulingClass != SchedulingClass::Default) {
+        int policy = SCHED_OTHER;
+        sched_param param{};
+        switch (placement.schedulingClass) {
+            case SchedulingClass::Default:
+            case SchedulingClass::Normal:
+                break;
+            case SchedulingClass::Batch:
+                policy = SCHED_BATCH;
+                break;
+            case SchedulingClass::Idle:
+                policy = SCHED_IDLE;
+                break;
+            case SchedulingClass::Fifo:
+                policy = SCHED_FIFO;
+                param.sched_priority = placement.priority;
+                break;
+            case SchedulingClass::RoundRobin:
+                policy = SCHED_RR;
+                param.sched_priority = placement.priority;
+                break;
+        }
+        applied &= pthread_setschedparam(self, policy, &param) == 0;
+    }
+    return applied;
+#else
+    return !placement.cpu &&
+           placement.schedulingClass == SchedulingClass::Default;
+#endif
+}
+
+}  // namespace eventTree::eventHubs
+
+#endif  // THREAD_PLACEMENT_H
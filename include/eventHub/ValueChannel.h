@@ -0,0 +1,188 @@
+#ifndef VALUE_CHANNEL_H
+#define VALUE_CHANNEL_H
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "SpecialEventQueue/Queues/MoodycamelQueue.h"  // NOLINT
+#include "SpecialEventQueue/SpecialEventQueue.h"
+#include "ThreadPlacement.h"
+#include "events/Event.h"
+
+namespace eventTree::eventHubs {
+
+/**
+ * @struct ChannelOptions
+ * @brief The dispatch threads of a ValueChannel, see SpecialHub::channel().
+ */
+struct ChannelOptions {
+    /**
+     * @brief Number of threads handling the channel's events. With more than
+     * one, events of the channel may be handled in parallel and out of order.
+     */
+    std::size_t workers = 1;
+
+    /**
+     * @brief CPU affinity and scheduling class of the threads, by worker
+     * index. Workers without an entry are left to the scheduler.
+     */
+    std::vector<ThreadPlacement> placement;
+};
+
+/**
+ * @brief Concept for event classes that can travel through a ValueChannel by
+ * value.
+ *
+ * The class names its EventType as `staticType`, and is default constructible
+ * and movable so that queues can store it inline.
+ *
+ * @tparam T The event class to check.
+ */
+template <typename T>
+concept ValueEventConcept =
+    std::derived_from<T, events::Event> && std::default_initializable<T> &&
+    std::movable<T> && requires {
+        { T::staticType } -> std::convertible_to<events::EventType>;
+    };
+
+namespace detail {
+
+/**
+ * @class ValueQueueBase
+ * @brief The queue of one ValueChannel, as seen by its dispatch thread.
+ *
+ * Only the dispatch loop goes through this interface, once per batch; events
+ * and handlers never do.
+ */
+class ValueQueueBase {
+   public:
+    ValueQueueBase() = default;
+    virtual ~ValueQueueBase() = default;
+
+    /**
+     * @brief Process one event.
+     * @param cursor The consumer's cursor.
+     * @return true if an event was processed, false otherwise.
+     */
+    virtual bool processOne(DispatchCursor& cursor) = 0;
+
+    /**
+     * @brief Process events until the queue is empty, a count is reached or
+     * a time budget runs out.
+     * @param budget The time budget.
+     * @param maxEvents The maximum number of events to process.
+     * @param cursor The consumer's cursor.
+     * @return The number of events processed.
+     */
+    virtual std::size_t processFor(std::chrono::microseconds budget,
+                                   std::size_t maxEvents,
+                                   DispatchCursor& cursor) = 0;
+
+    /**
+     * @brief Blocks until an event may be pending or shouldStop returns
+     * true.
+     * @param shouldStop Checked before sleeping.
+     */
+    virtual void waitForEvents(const std::function<bool()>& shouldStop) = 0;
+
+    /** @brief Wakes every consumer blocked in waitForEvents(). */
+    virtual void notifyAll() = 0;
+
+    // Special constructors to comply with "rule of 5"
+    ValueQueueBase(const ValueQueueBase&) = delete;
+    ValueQueueBase& operator=(const ValueQueueBase&) = delete;
+    ValueQueueBase(ValueQueueBase&&) = delete;
+    ValueQueueBase& operator=(ValueQueueBase&&) = delete;
+};
+
+/**
+ * @class ValueQueue
+ * @brief Events of one class, stored by value.
+ * @tparam T The event class.
+ */
+template <ValueEventConcept T>
+class ValueQueue final : public ValueQueueBase {
+   public:
+    /** @brief The queue, keyed by the single EventType of T. */
+    using Queue = SpecialEventQueue<events::EventType,
+                                    std::function<void(const T&)>,
+                                    queues::MoodycamelQueue<T>>;
+
+    Queue queue;                                 ///< The queued events.
+    typename Queue::Channel channel{
+        queue.channel(T::staticType)};  ///< The slot of T.
+
+    bool processOne(DispatchCursor& cursor) override {
+        return queue.processOne(cursor);
+    }
+
+    std::size_t processFor(std::chrono::microseconds budget,
+                           std::size_t maxEvents,
+                           DispatchCursor& cursor) override {
+        return queue.processFor(budget, maxEvents, cursor);
+    }
+
+    void waitForEvents(const std::function<bool()>& shouldStop) override {
+        queue.waitForEvents(shouldStop);
+    }
+
+    void notifyAll() override { queue.notifyAll(); }
+};
+
+}  // namespace detail
+
+/**
+ * @class ValueChannel
+ * @brief Emits events of one class by value and registers handlers that
+ * receive them by reference, see SpecialHub::channel().
+ *
+ * Events are moved into the channel's queue and stay there until their
+ * handlers ran, without a shared_ptr, a heap allocation or a downcast. A
+ * channel is cheap to copy and stays valid as long as its hub.
+ *
+ * @tparam T The event class.
+ */
+template <ValueEventConcept T>
+class ValueChannel {
+   private:
+    detail::ValueQueue<T>* valueQueue;  ///< The queue of T.
+
+   public:
+    /**
+     * @brief Constructs a channel on a queue.
+     * @param valueQueue The queue of T, owned by the hub.
+     */
+    explicit ValueChannel(detail::ValueQueue<T>& valueQueue)
+        : valueQueue(&valueQueue) {}
+
+    /**
+     * @brief Emits an event.
+     * @tparam U The type of the event, convertible to T.
+     * @param event The event, moved or copied into the queue.
+     */
+    template <typename U>
+        requires std::constructible_from<T, U&&>
+    void emit(U&& event) {
+        valueQueue->channel.push(std::forward<U>(event));
+    }
+
+    /**
+     * @brief Registers a handler for the events of this channel.
+     *
+     * Only events emitted through a channel of T reach it; events of the
+     * same type emitted as an EventPtr go to the hub's other handlers.
+     *
+     * @param handler The handler function.
+     */
+    void registerHandler(std::function<void(const T&)> handler) {
+        valueQueue->queue.appendListener(T::staticType, std::move(handler));
+    }
+};
+
+}  // namespace eventTree::eventHubs
+
+#endif  // VALUE_CHANNEL_H
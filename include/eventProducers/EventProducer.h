@@ -1,6 +1,7 @@
 #ifndef EVENT_PRODUCER_H
 #define EVENT_PRODUCER_H
 
+#include <atomic>
 #include <memory>
 
 #include "eventHub/IEventHub.h"
@@ -12,7 +13,8 @@ namespace eventTree::eventProducers {
  * @brief Base class for event-producing entities.
  *
  * EventProducer provides a common interface for classes that generate events.
- * It holds a reference to an IEventHub for emitting events.
+ * It holds a reference to an IEventHub for emitting events, and a producer id
+ * that lets the hub schedule fairly between producers.
  */
 class EventProducer {
    public:
@@ -24,7 +26,8 @@ class EventProducer {
      * @param eventEmitter Shared pointer to an IEventHub instance.
      */
     explicit EventProducer(EventEmitterPointer eventEmitter)  // NOLINT
-        : eventEmitter(eventEmitter) {}                       // NOLINT
+        : eventEmitter(eventEmitter),                         // NOLINT
+          producerId(nextProducerId()) {}
 
     /**
      * @brief Getter for the event emitter.
@@ -32,6 +35,29 @@ class EventProducer {
      */
     EventEmitterPointer getEventEmitter() { return eventEmitter; }
 
+    /**
+     * @brief Opens a handle that emits this producer's events.
+     *
+     * The handle owns the producer's state in the hub, e.g. queue tokens, so
+     * it is meant to be opened and used by the thread producing the events.
+     *
+     * @return The handle, or nullptr if there is no event emitter.
+     */
+    std::unique_ptr<eventHubs::EmitHandle> openEmitHandle() {
+        if (eventEmitter == nullptr) {
+            return nullptr;
+        }
+        return eventEmitter->openEmitHandle(producerId);
+    }
+
+    /**
+     * @brief Getter for the producer id.
+     * @return The id this producer emits its events with.
+     */
+    [[nodiscard]] eventHubs::ProducerId getProducerId() const {
+        return producerId;
+    }
+
     /**
      * @brief Virtual destructor.
      *
@@ -47,6 +73,16 @@ class EventProducer {
    private:
     EventEmitterPointer
         eventEmitter; /**< Shared pointer to the IEventHub instance */
+    eventHubs::ProducerId producerId; /**< Unique, non-zero producer id. */
+
+    /**
+     * @brief Hands out producer ids.
+     * @return An id no other producer has been given.
+     */
+    static eventHubs::ProducerId nextProducerId() {
+        static std::atomic<eventHubs::ProducerId> lastId{0};
+        return lastId.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
 
     /**
      * @brief Pure virtual function to produce events.
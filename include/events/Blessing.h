@@ -17,18 +17,27 @@ namespace eventTree::events {
  */
 class Blessing : public Event {
    public:
+    /** @brief The EventType of every Blessing event. */
+    static constexpr EventType staticType = EventType::Blessing;
+
+    /**
+     * @brief Constructs a Blessing event without a target land, e.g. to be
+     * filled in by a queue.
+     */
+    Blessing() : Event(staticType) {}
+
     /**
      * @brief Constructs a Blessing event.
      * @param target_land The land targeted by the blessing.
      */
     explicit Blessing(std::string target_land)
-        : Event(EventType::Blessing), target_land(std::move(target_land)) {}
+        : Event(staticType), target_land(std::move(target_land)) {}
 
     /**
      * @brief Gets the target land of the blessing.
      * @return The name of the land targeted by the blessing.
      */
-    std::string get_target_land() { return target_land; }
+    std::string get_target_land() const { return target_land; }
 
    private:
     std::string target_land; /**< The land targeted by the blessing */
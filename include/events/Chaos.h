@@ -17,18 +17,27 @@ namespace eventTree::events {
  */
 class Chaos : public Event {
    public:
+    /** @brief The EventType of every Chaos event. */
+    static constexpr EventType staticType = EventType::Chaos;
+
+    /**
+     * @brief Constructs a Chaos event without a target land, e.g. to be
+     * filled in by a queue.
+     */
+    Chaos() : Event(staticType) {}
+
     /**
      * @brief Constructs a Chaos event.
      * @param target_land The land targeted by the chaos.
      */
     explicit Chaos(std::string target_land)
-        : Event(EventType::Chaos), target_land(std::move(target_land)) {}
+        : Event(staticType), target_land(std::move(target_land)) {}
 
     /**
      * @brief Gets the target land of the chaos.
      * @return The name of the land targeted by the chaos.
      */
-    std::string get_target_land() { return target_land; }
+    std::string get_target_land() const { return target_land; }
 
    private:
     std::string target_land; /**< The land targeted by the chaos */
@@ -0,0 +1,282 @@
+#ifndef EVENT_POOL_H
+#define EVENT_POOL_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace eventTree::events {
+
+namespace detail {
+
+/**
+ * @class BlockPool
+ * @brief Recycles memory blocks sized and aligned for one type.
+ *
+ * @tparam T The type the blocks hold.
+ *
+ * Every thread allocates from and frees to its own cache without locking.
+ * Blocks freed on a thread other than the one that allocated them, e.g. a
+ * dispatcher dropping the last reference to an event, pile up in the freeing
+ * thread's cache; once it holds two batches, one batch goes to a list shared
+ * by all threads, where a thread with an empty cache takes it. Only when the
+ * shared list is empty as well is a new chunk of blocks allocated.
+ *
+ * Chunks are never freed. Events may be released during static destruction,
+ * or by a thread-local object after the thread's cache is gone, so the shared
+ * state is deliberately leaked and such late releases go straight to the
+ * shared list.
+ */
+template <typename T>
+class BlockPool {
+   private:
+    /** @brief Blocks moved between a cache and the shared list at once. */
+    static constexpr std::size_t batchSize = 64;
+
+    /**
+     * @struct FreeBlock
+     * @brief A block that is not in use, linked to the next free one.
+     */
+    struct FreeBlock {
+        FreeBlock* next;  ///< The next free block.
+    };
+
+    static constexpr std::size_t blockAlign =
+        alignof(T) > alignof(FreeBlock) ? alignof(T) : alignof(FreeBlock);
+    static constexpr std::size_t blockSize =
+        ((sizeof(T) > sizeof(FreeBlock) ? sizeof(T) : sizeof(FreeBlock)) +
+         blockAlign - 1) /
+        blockAlign * blockAlign;
+
+    /**
+     * @struct Batch
+     * @brief A list of free blocks.
+     */
+    struct Batch {
+        FreeBlock* head = nullptr;  ///< The first block.
+        std::size_t count = 0;      ///< The number of blocks.
+    };
+
+    /**
+     * @struct Shared
+     * @brief Free batches and allocated chunks, shared by all threads.
+     */
+    struct Shared {
+        std::mutex mutex;            ///< Guards the members below.
+        std::vector<Batch> batches;  ///< Batches handed back by caches.
+        std::vector<void*> chunks;   ///< Every chunk, kept reachable.
+    };
+
+    /**
+     * @struct Cache
+     * @brief The free blocks of one thread.
+     */
+    struct Cache {
+        Batch blocks;     ///< The thread's free blocks.
+        bool& destroyed;  ///< Set once the cache must no longer be used.
+
+        /**
+         * @brief Constructs an empty cache.
+         * @param destroyed A flag that outlives the cache.
+         */
+        explicit Cache(bool& destroyed) : destroyed(destroyed) {}
+        ~Cache() {
+            destroyed = true;
+            if (blocks.count != 0) {
+                auto& pool = shared();
+                std::lock_guard<std::mutex> lock(pool.mutex);
+                pool.batches.push_back(blocks);
+            }
+        }
+
+        // Special constructors to comply with "rule of 5"
+        Cache(const Cache&) = delete;
+        Cache& operator=(const Cache&) = delete;
+        Cache(Cache&&) = delete;
+        Cache& operator=(Cache&&) = delete;
+    };
+
+    static Shared& shared() {
+        // Never destroyed, see the class comment.
+        static auto* pool = new Shared();
+        return *pool;
+    }
+
+    /**
+     * @brief The calling thread's cache.
+     * @return The cache, or nullptr once it was destroyed at thread exit.
+     */
+    static Cache* cache() {
+        // Trivially destructible, so still readable once local is gone.
+        thread_local bool destroyed = false;
+        if (destroyed) {
+            return nullptr;
+        }
+        thread_local Cache local(destroyed);
+        return &local;
+    }
+
+    /**
+     * @brief Fills an empty cache with a shared batch, or a new chunk.
+     * @param local The calling thread's cache.
+     */
+    static void refill(Cache& local) {
+        auto& pool = shared();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (!pool.batches.empty()) {
+            local.blocks = pool.batches.back();
+            pool.batches.pop_back();
+            return;
+        }
+        auto* chunk = static_cast<std::byte*>(::operator new(
+            blockSize * batchSize, std::align_val_t{blockAlign}));
+        pool.chunks.push_back(chunk);
+        for (std::size_t i = 0; i < batchSize; ++i) {
+            auto* block =
+                new (chunk + i * blockSize) FreeBlock{local.blocks.head};
+            local.blocks.head = block;
+        }
+        local.blocks.count = batchSize;
+    }
+
+    /**
+     * @brief Hands one batch of a full cache to the shared list.
+     * @param local The calling thread's cache.
+     */
+    static void spill(Cache& local) {
+        Batch batch;
+        for (; batch.count < batchSize; ++batch.count) {
+            auto* block = local.blocks.head;
+            local.blocks.head = block->next;
+            block->next = batch.head;
+            batch.head = block;
+        }
+        local.blocks.count -= batchSize;
+        auto& pool = shared();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.batches.push_back(batch);
+    }
+
+   public:
+    /**
+     * @brief Takes a free block.
+     * @return Storage for one T.
+     */
+    static void* allocate() {
+        auto* local = cache();
+        if (local == nullptr) {
+            // Thread exit; the block joins the pool once it is released.
+            return ::operator new(blockSize, std::align_val_t{blockAlign});
+        }
+        if (local->blocks.count == 0) {
+            refill(*local);
+        }
+        auto* block = local->blocks.head;
+        local->blocks.head = block->next;
+        local->blocks.count--;
+        return block;
+    }
+
+    /**
+     * @brief Returns a block to the calling thread's cache.
+     * @param pointer A block from allocate(), on any thread.
+     */
+    static void deallocate(void* pointer) {
+        auto* local = cache();
+        if (local == nullptr) {
+            // Thread exit; hand the block over as a batch of its own.
+            auto& pool = shared();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            pool.batches.push_back(Batch{new (pointer) FreeBlock{nullptr}, 1});
+            return;
+        }
+        if (local->blocks.count == 2 * batchSize) {
+            spill(*local);
+        }
+        local->blocks.head = new (pointer) FreeBlock{local->blocks.head};
+        local->blocks.count++;
+    }
+};
+
+}  // namespace detail
+
+/**
+ * @class PoolAllocator
+ * @brief An allocator that takes single objects from a per-type BlockPool.
+ *
+ * @tparam T The type of the allocated objects.
+ *
+ * Meant for std::allocate_shared(), which rebinds it to the control block
+ * holding the event, so an event and its reference counts share one
+ * recycled block. Arrays fall back to the global operator new.
+ */
+template <typename T>
+class PoolAllocator {
+   public:
+    using value_type = T;  ///< The type of the allocated objects.
+
+    PoolAllocator() noexcept = default;
+
+    /**
+     * @brief Converts from an allocator of another type; all are equal.
+     */
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& /*other*/) noexcept {}  // NOLINT
+
+    /**
+     * @brief Allocates storage for objects.
+     * @param count The number of objects.
+     * @return The storage.
+     */
+    T* allocate(std::size_t count) {
+        if (count != 1) {
+            return static_cast<T*>(::operator new(
+                count * sizeof(T), std::align_val_t{alignof(T)}));
+        }
+        return static_cast<T*>(detail::BlockPool<T>::allocate());
+    }
+
+    /**
+     * @brief Releases storage from allocate().
+     * @param pointer The storage.
+     * @param count The number of objects it was allocated for.
+     */
+    void deallocate(T* pointer, std::size_t count) noexcept {
+        if (count != 1) {
+            ::operator delete(pointer, std::align_val_t{alignof(T)});
+            return;
+        }
+        detail::BlockPool<T>::deallocate(pointer);
+    }
+
+    /** @brief Pool allocators are interchangeable. */
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+};
+
+/**
+ * @brief Creates an event in recycled storage, in place of
+ * std::make_shared().
+ *
+ * The event may be released on any thread; its block then returns to the
+ * pool of that thread and, in batches, to the other threads.
+ *
+ * @tparam T The event class.
+ * @tparam Args The types of the constructor arguments.
+ * @param args The constructor arguments.
+ * @return A shared pointer to the new event.
+ */
+template <typename T, typename... Args>
+std::shared_ptr<T> makePooled(Args&&... args) {
+    return std::allocate_shared<T>(PoolAllocator<T>{},
+                                   std::forward<Args>(args)...);
+}
+
+}  // namespace eventTree::events
+
+#endif  // EVENT_POOL_H
@@ -17,18 +17,27 @@ namespace eventTree::events {
  */
 class Flood : public Event {
    public:
+    /** @brief The EventType of every Flood event. */
+    static constexpr EventType staticType = EventType::Flood;
+
+    /**
+     * @brief Constructs a Flood event without a target land, e.g. to be
+     * filled in by a queue.
+     */
+    Flood() : Event(staticType) {}
+
     /**
      * @brief Constructs a Flood event.
      * @param target_land The land targeted by the flood.
      */
     explicit Flood(std::string target_land)
-        : Event(EventType::Flood), target_land(std::move(target_land)) {}
+        : Event(staticType), target_land(std::move(target_land)) {}
 
     /**
      * @brief Gets the target land of the flood.
      * @return The name of the land targeted by the flood.
      */
-    std::string get_target_land() { return target_land; }
+    std::string get_target_land() const { return target_land; }
 
    private:
     std::string target_land; /**< The land targeted by the flood */
@@ -17,18 +17,27 @@ namespace eventTree::events {
  */
 class Joy : public Event {
    public:
+    /** @brief The EventType of every Joy event. */
+    static constexpr EventType staticType = EventType::Joy;
+
+    /**
+     * @brief Constructs a Joy event without a target land, e.g. to be
+     * filled in by a queue.
+     */
+    Joy() : Event(staticType) {}
+
     /**
      * @brief Constructs a Joy event.
      * @param target_land The land targeted by the joy.
      */
     explicit Joy(std::string target_land)
-        : Event(EventType::Joy), target_land(std::move(target_land)) {}
+        : Event(staticType), target_land(std::move(target_land)) {}
 
     /**
      * @brief Gets the target land of the joy.
      * @return The name of the land targeted by the joy.
      */
-    std::string get_target_land() { return target_land; }
+    std::string get_target_land() const { return target_land; }
 
    private:
     std::string target_land; /**< The land targeted by the joy */
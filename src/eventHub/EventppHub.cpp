@@ -1,13 +1,17 @@
 #include "eventHub/EventppHub.h"
 
 #include <chrono>
+#include <cstddef>
 #include <functional>
 #include <thread>
+#include <utility>
 
 #include "events/Event.h"
 
-eventTree::eventHubs::EventppHub::EventppHub()
-    : dispatch_thread(&eventTree::eventHubs::EventppHub::dispatchEvents, this) {
+eventTree::eventHubs::EventppHub::EventppHub(DispatchOptions options)
+    : options(options),
+      idleStrategy(options.idle),
+      dispatch_thread(&eventTree::eventHubs::EventppHub::dispatchEvents, this) {
 }
 
 eventTree::eventHubs::EventppHub::~EventppHub() {
@@ -19,8 +23,28 @@ eventTree::eventHubs::EventppHub::~EventppHub() {
 
 void eventTree::eventHubs::EventppHub::dispatchEvents() {
     while (running) {
-        queue.processOne();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));  // NOLINT
+        if (options.mode == DispatchMode::PollOne) {
+            queue.processOne();
+            std::this_thread::sleep_for(options.idleSleep);
+            continue;
+        }
+
+        // Same budgets as SpecialHub, so both hubs can be compared fairly.
+        auto deadline = std::chrono::steady_clock::now() + options.batchTime;
+        std::size_t processed = 0;
+        while (processed < options.batchEvents && queue.processOne()) {
+            ++processed;
+            if (std::chrono::steady_clock::now() >= deadline) {
+                break;
+            }
+        }
+        if (processed != 0) {
+            idleStrategy.reset();
+            continue;
+        }
+        // eventpp wakes waiters on enqueue; the timeout bounds how long
+        // shutdown can go unnoticed when parked.
+        idleStrategy.idle([this] { queue.waitFor(options.idleSleep); });
     }
 }
 
@@ -34,6 +58,11 @@ void eventTree::eventHubs::EventppHub::emitEvent(events::EventType type,
 }
 
 void eventTree::eventHubs::EventppHub::registerHandler(
-    events::EventType type, std::function<void(events::EventPtr)> func) {
-    queue.appendListener(type, func);
+    events::EventType type, EventHandler func) {
+    queue.appendListener(type, std::move(func));
+}
+
+eventTree::eventHubs::IdleStats eventTree::eventHubs::EventppHub::idleStats()
+    const {
+    return idleStrategy.stats();
 }
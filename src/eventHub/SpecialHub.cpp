@@ -1,35 +1,386 @@
 #include "eventHub/SpecialHub.h"
 
+#include <algorithm>
 #include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <thread>
+#include <type_traits>
+#include <typeindex>
+#include <utility>
+#include <vector>
 
 #include "events/Event.h"
 
-eventTree::eventHubs::SpecialHub::SpecialHub()
-    : dispatch_thread(&eventTree::eventHubs::SpecialHub::dispatchEvents, this) {
+eventTree::eventHubs::SpecialHub::SpecialHub(
+    DispatchOptions options, const std::vector<PinnedWorker>& pinned,
+    StrandOptions strands)
+    : queue(options.priorityAging),
+      options(options),
+      strandOptions(std::move(strands)) {
+    if (strandOptions.key) {
+        strandOptions.strands = std::max<std::size_t>(strandOptions.strands, 1);
+        strandQueue = std::make_unique<StrandQueue>(SlotOrdering::Serial);
+        for (std::size_t strand = 0; strand < strandOptions.strands; ++strand) {
+            strandQueue->appendListener(
+                strand, [this](const StrandedEvent& stranded) {
+                    queue.dispatch(stranded.type, stranded.event);
+                });
+        }
+    }
+
+    // Routes are settled before any thread starts, so that a worker left
+    // without types can be refused without threads to clean up.
+    for (const auto& dedicated : pinned) {
+        auto& pinnedQueue =
+            *pinnedQueues.emplace_back(std::make_unique<EventQueue>());
+        bool owns = false;
+        for (auto type : dedicated.types) {
+            auto& route = routes[static_cast<std::size_t>(
+                static_cast<std::underlying_type_t<events::EventType>>(type))];
+            if (route == nullptr) {
+                route = &pinnedQueue;
+                owns = true;
+            }
+        }
+        if (!owns) {
+            throw std::invalid_argument(
+                "SpecialHub: a pinned worker owns no event types");
+        }
+    }
+    for (std::size_t index = 0; index < pinned.size(); ++index) {
+        const auto& dedicated = pinned[index];
+        auto& pinnedQueue = *pinnedQueues[index];
+        auto& worker = *pinnedWorkers.emplace_back(
+            std::make_unique<Worker>(options.idle, dedicated.placement));
+        worker.thread = std::thread(
+            &eventTree::eventHubs::SpecialHub::dispatchEvents<EventQueue>,
+            this, std::ref(worker), std::ref(pinnedQueue));
+    }
+
+    auto workerCount = std::max<std::size_t>(options.workers, 1);
+    workers.reserve(std::max(workerCount, options.elastic.maxWorkers));
+    for (std::size_t index = 0; index < workerCount; ++index) {
+        startWorker();
+    }
+    if (options.elastic.maxWorkers > workerCount) {
+        supervisor = std::thread(
+            &eventTree::eventHubs::SpecialHub::superviseWorkers, this);
+    }
 }
 
 eventTree::eventHubs::SpecialHub::~SpecialHub() {
     running = false;
-    if (dispatch_thread.joinable()) {
-        dispatch_thread.join();
+    if (supervisor.joinable()) {
+        supervisor.join();
+    }
+    queue.notifyAll();
+    if (strandQueue) {
+        strandQueue->notifyAll();
+    }
+    for (auto& pinnedQueue : pinnedQueues) {
+        pinnedQueue->notifyAll();
+    }
+
+    // Joined without the lock, so that a handler still reading stats or
+    // opening a channel can finish.
+    std::vector<std::unique_ptr<Worker>> stopping;
+    {
+        std::lock_guard<std::mutex> lock(workersMutex);
+        for (auto& [type, valueQueue] : valueQueues) {
+            valueQueue->notifyAll();
+        }
+        for (auto* group : {&workers, &pinnedWorkers, &valueWorkers}) {
+            std::move(group->begin(), group->end(),
+                      std::back_inserter(stopping));
+            group->clear();
+        }
+    }
+    for (auto& worker : stopping) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+void eventTree::eventHubs::SpecialHub::startWorker() {
+    auto index = workers.size();
+    auto placement = index < options.placement.size()
+                         ? options.placement[index]
+                         : ThreadPlacement{};
+    auto worker = std::make_unique<Worker>(options.idle, placement);
+    // Staggered cursors keep workers from starting on the same type.
+    worker->cursor.position = index;
+    for (auto& laneCursor : worker->laneCursors.lanes) {
+        laneCursor.producers.position = index;
+        laneCursor.laneStart = index;
+    }
+    if (strandQueue) {
+        worker->thread = std::thread(
+            &eventTree::eventHubs::SpecialHub::dispatchEvents<StrandQueue>,
+            this, std::ref(*worker), std::ref(*strandQueue));
+    } else {
+        worker->thread = std::thread(
+            &eventTree::eventHubs::SpecialHub::dispatchEvents<SharedQueue>,
+            this, std::ref(*worker), std::ref(queue));
     }
+    workers.push_back(std::move(worker));
+    scaling.workers = workers.size();
 }
 
-void eventTree::eventHubs::SpecialHub::dispatchEvents() {
+std::unique_ptr<eventTree::eventHubs::SpecialHub::Worker>
+eventTree::eventHubs::SpecialHub::detachWorker() {
+    auto worker = std::move(workers.back());
+    workers.pop_back();
+    scaling.workers = workers.size();
+    worker->retiring = true;
+    return worker;
+}
+
+void eventTree::eventHubs::SpecialHub::retireWorker(
+    std::unique_ptr<Worker> worker) {
+    queue.notifyAll();
+    if (strandQueue) {
+        strandQueue->notifyAll();
+    }
+    worker->thread.join();
+
+    auto stats = worker->idleStrategy.stats();
+    std::lock_guard<std::mutex> lock(workersMutex);
+    retiredIdleStats.emptyPolls += stats.emptyPolls;
+    retiredIdleStats.idleTime += stats.idleTime;
+    retiredProcessed += worker->processed.load(std::memory_order_relaxed);
+    ++scaling.scaleDowns;
+}
+
+template <typename Queue>
+void eventTree::eventHubs::SpecialHub::dispatchEvents(Worker& worker,
+                                                      Queue& queue) {
+    // A refused placement is not fatal; the thread just runs unpinned.
+    applyToCurrentThread(worker.placement);
+
+    // The shared queue's lanes each need their own position.
+    auto& cursor = [&worker]() -> auto& {
+        if constexpr (std::same_as<Queue, SharedQueue>) {
+            return worker.laneCursors;
+        } else {
+            return worker.cursor;
+        }
+    }();
+
+    auto active = [this, &worker] { return running && !worker.retiring; };
+    while (active()) {
+        if (options.mode == DispatchMode::PollOne) {
+            if (queue.processOne(cursor)) {
+                worker.processed.fetch_add(1, std::memory_order_relaxed);
+            }
+            std::this_thread::sleep_for(options.idleSleep);
+            continue;
+        }
+
+        // Only an empty pass idles; an exhausted budget loops right away.
+        auto processed = queue.processFor(options.batchTime,
+                                          options.batchEvents, cursor);
+        if (processed != 0) {
+            worker.processed.fetch_add(processed, std::memory_order_relaxed);
+            worker.idleStrategy.reset();
+            continue;
+        }
+        worker.idleStrategy.idle([&queue, &active] {
+            queue.waitForEvents([&active] { return !active(); });
+        });
+    }
+}
+
+void eventTree::eventHubs::SpecialHub::superviseWorkers() {
+    ScalingPolicy policy(options.elastic,
+                         std::max<std::size_t>(options.workers, 1),
+                         ScalingPolicy::Clock::now());
+
     while (running) {
-        queue.processOne();
-        std::this_thread::sleep_for(std::chrono::milliseconds(10));  // NOLINT
+        std::this_thread::sleep_for(options.elastic.sampleInterval);
+        auto now = ScalingPolicy::Clock::now();
+        auto depth =
+            strandQueue ? strandQueue->pendingEvents() : queue.pendingEvents();
+
+        std::unique_ptr<Worker> retired;
+        {
+            std::lock_guard<std::mutex> lock(workersMutex);
+            auto processed = retiredProcessed;
+            for (const auto& worker : workers) {
+                processed += worker->processed.load(std::memory_order_relaxed);
+            }
+
+            switch (policy.sample(now, depth, processed, workers.size())) {
+                case ScalingDecision::ScaleUp:
+                    startWorker();
+                    ++scaling.scaleUps;
+                    break;
+                case ScalingDecision::ScaleDown:
+                    retired = detachWorker();
+                    break;
+                case ScalingDecision::Keep:
+                    break;
+            }
+            scaling.lastDepth = policy.lastDepth();
+            scaling.lastBacklogAge = policy.lastBacklogAge();
+        }
+        // Joined before the next sample, so its events are counted again by
+        // then.
+        if (retired) {
+            retireWorker(std::move(retired));
+        }
     }
 }
 
+eventTree::eventHubs::SpecialHub::EventQueue*
+eventTree::eventHubs::SpecialHub::pinnedQueueFor(events::EventType type) {
+    return routes[static_cast<std::size_t>(
+        static_cast<std::underlying_type_t<events::EventType>>(type))];
+}
+
 void eventTree::eventHubs::SpecialHub::emitEvent(events::EventType type,
                                                  events::EventPtr event) {
-    queue.enqueue(type, event);
+    emitEvent(ProducerId{}, type, std::move(event));
+}
+
+void eventTree::eventHubs::SpecialHub::emitEvent(ProducerId producer,
+                                                 events::EventType type,
+                                                 events::EventPtr event) {
+    emitEvent(producer, type, std::move(event), Priority::Normal);
+}
+
+void eventTree::eventHubs::SpecialHub::emitEvent(events::EventType type,
+                                                 events::EventPtr event,
+                                                 Priority priority) {
+    emitEvent(ProducerId{}, type, std::move(event), priority);
+}
+
+void eventTree::eventHubs::SpecialHub::emitEvent(ProducerId producer,
+                                                 events::EventType type,
+                                                 events::EventPtr event,
+                                                 Priority priority) {
+    if (auto* pinnedQueue = pinnedQueueFor(type)) {
+        pinnedQueue->enqueue(type, std::move(event));
+    } else if (strandQueue) {
+        auto strand = strandOptions.key(type, event) % strandOptions.strands;
+        strandQueue->enqueue(strand, StrandedEvent{type, std::move(event)});
+    } else {
+        queue.enqueue(static_cast<std::size_t>(priority), producer, type,
+                      std::move(event));
+    }
+}
+
+class eventTree::eventHubs::SpecialHub::ProducerHandle : public EmitHandle {
+   private:
+    SpecialHub& hub;     /**< The hub events are emitted to. */
+    ProducerId producer; /**< The producer they are emitted for. */
+
+    /** @brief The producer's token of each priority lane. */
+    std::vector<ProducerQueue::ProducerToken> tokens;
+
+    /** @brief Channel of each pinned type; routes never change. */
+    std::vector<std::optional<EventQueue::Channel>> pinnedChannels;
+
+   public:
+    ProducerHandle(SpecialHub& hub, ProducerId producer)
+        : hub(hub), producer(producer), pinnedChannels(eventTypeCount) {
+        tokens.reserve(SharedQueue::laneCount);
+        for (std::size_t lane = 0; lane < SharedQueue::laneCount; ++lane) {
+            tokens.push_back(hub.queue.producerToken(lane, producer));
+        }
+        for (std::size_t index = 0; index < eventTypeCount; ++index) {
+            if (auto* pinnedQueue = hub.routes[index]) {
+                pinnedChannels[index].emplace(pinnedQueue->channel(
+                    static_cast<events::EventType>(index)));
+            }
+        }
+    }
+
+    using EmitHandle::emitEvent;
+
+    void emitEvent(events::EventType type, events::EventPtr event,
+                   Priority priority) override {
+        auto& pinned = pinnedChannels[static_cast<std::size_t>(
+            static_cast<std::underlying_type_t<events::EventType>>(type))];
+        if (pinned) {
+            pinned->push(std::move(event));
+            return;
+        }
+        if (hub.strandQueue) {
+            hub.emitEvent(producer, type, std::move(event), priority);
+            return;
+        }
+        auto lane = static_cast<std::size_t>(priority);
+        hub.queue.enqueue(lane, tokens[lane], type, std::move(event));
+    }
+};
+
+eventTree::eventHubs::detail::ValueQueueBase&
+eventTree::eventHubs::SpecialHub::valueQueueFor(
+    std::type_index type, const ChannelOptions& channelOptions,
+    const std::function<std::unique_ptr<detail::ValueQueueBase>()>& make) {
+    std::lock_guard<std::mutex> lock(workersMutex);
+    auto& valueQueue = valueQueues[type];
+    if (valueQueue == nullptr) {
+        valueQueue = make();
+        if (!running) {
+            // The destructor has collected the threads to join already.
+            return *valueQueue;
+        }
+        auto workerCount = std::max<std::size_t>(channelOptions.workers, 1);
+        for (std::size_t index = 0; index < workerCount; ++index) {
+            auto placement = index < channelOptions.placement.size()
+                                 ? channelOptions.placement[index]
+                                 : ThreadPlacement{};
+            auto& worker = *valueWorkers.emplace_back(
+                std::make_unique<Worker>(options.idle, placement));
+            worker.thread = std::thread(
+                &eventTree::eventHubs::SpecialHub::dispatchEvents<
+                    detail::ValueQueueBase>,
+                this, std::ref(worker), std::ref(*valueQueue));
+        }
+    }
+    return *valueQueue;
+}
+
+std::unique_ptr<eventTree::eventHubs::EmitHandle>
+eventTree::eventHubs::SpecialHub::openEmitHandle(ProducerId producer) {
+    return std::make_unique<ProducerHandle>(*this, producer);
 }
 
 void eventTree::eventHubs::SpecialHub::registerHandler(
-    events::EventType type, std::function<void(events::EventPtr)> func) {
-    queue.appendListener(type, func);
+    events::EventType type, EventHandler func) {
+    if (auto* pinnedQueue = pinnedQueueFor(type)) {
+        pinnedQueue->appendListener(type, std::move(func));
+    } else {
+        queue.appendListener(type, std::move(func));
+    }
+}
+
+eventTree::eventHubs::IdleStats eventTree::eventHubs::SpecialHub::idleStats()
+    const {
+    std::lock_guard<std::mutex> lock(workersMutex);
+    IdleStats total = retiredIdleStats;
+    for (const auto* pool : {&workers, &pinnedWorkers, &valueWorkers}) {
+        for (const auto& worker : *pool) {
+            auto stats = worker->idleStrategy.stats();
+            total.emptyPolls += stats.emptyPolls;
+            total.idleTime += stats.idleTime;
+        }
+    }
+    return total;
+}
+
+eventTree::eventHubs::ScalingStats
+eventTree::eventHubs::SpecialHub::scalingStats() const {
+    std::lock_guard<std::mutex> lock(workersMutex);
+    return scaling;
 }
@@ -6,21 +6,22 @@
 
 #include "events/Chaos.h"
 #include "events/Event.h"
+#include "events/EventPool.h"
 #include "events/Flood.h"
 
 void eventTree::eventProducers::Ahriman::produceEvents() {
-    auto emitter = getEventEmitter();
+    auto emitter = openEmitHandle();
     if (emitter == nullptr) {
         return;
     }
     for (int i = 0; i < 4; ++i) {  // NOLINT
 
         emitter->emitEvent(events::EventType::Flood,
-                           std::make_shared<events::Flood>("Iran"));
+                           events::makePooled<events::Flood>("Iran"));
         std::this_thread::sleep_for(std::chrono::milliseconds(50));  // NOLINT
 
         emitter->emitEvent(events::EventType::Chaos,
-                           std::make_shared<events::Chaos>("Iraq"));
+                           events::makePooled<events::Chaos>("Iraq"));
         std::this_thread::sleep_for(std::chrono::milliseconds(50));  // NOLINT
     }
 }
@@ -6,20 +6,21 @@
 
 #include "events/Blessing.h"
 #include "events/Event.h"
+#include "events/EventPool.h"
 #include "events/Joy.h"
 
 void eventTree::eventProducers::Anahita::produceEvents() {
-    auto emitter = getEventEmitter();
+    auto emitter = openEmitHandle();
     if (emitter == nullptr) {
         return;
     }
     for (int i = 0; i < 5; ++i) {  // NOLINT
         emitter->emitEvent(events::EventType::Blessing,
-                           std::make_shared<events::Blessing>("Iran"));
+                           events::makePooled<events::Blessing>("Iran"));
         std::this_thread::sleep_for(std::chrono::milliseconds(10));  // NOLINT
 
         emitter->emitEvent(events::EventType::Joy,
-                           std::make_shared<events::Joy>("Iraq"));
+                           events::makePooled<events::Joy>("Iraq"));
         std::this_thread::sleep_for(std::chrono::milliseconds(50));  // NOLINT
     }
 }
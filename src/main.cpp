@@ -17,12 +17,11 @@ int main() {
     using eventTree::eventHubs::EventppHub;
     using eventTree::eventHubs::SpecialHub;
 
-    using eventTree::events::EventPtr;
+    using eventTree::events::Event;
 
     using eventTree::eventProducers::Ahriman;
     using eventTree::eventProducers::Anahita;
 
-    using eventTree::events::EventPtr;
     // EventType
     using eventTree::events::EventType;
 
@@ -34,24 +33,24 @@ int main() {
     // auto hub = std::make_shared<EventppHub>();
     auto hub = std::make_shared<SpecialHub>();
 
-    hub->registerHandler(EventType::Blessing, [](EventPtr event) {  // NOLINT
-        auto blessing = std::static_pointer_cast<Blessing>(event);
-        std::cout << "Blessing received for: " << blessing->get_target_land()
+    hub->registerHandler(EventType::Blessing, [](const Event& event) {
+        const auto& blessing = static_cast<const Blessing&>(event);
+        std::cout << "Blessing received for: " << blessing.get_target_land()
                   << "\n";
     });
-    hub->registerHandler(EventType::Joy, [](EventPtr event) {  // NOLINT
-        auto joy = std::static_pointer_cast<Joy>(event);
-        std::cout << "Joy spread over: " << joy->get_target_land() << "\n";
+    hub->registerHandler(EventType::Joy, [](const Event& event) {
+        const auto& joy = static_cast<const Joy&>(event);
+        std::cout << "Joy spread over: " << joy.get_target_land() << "\n";
     });
 
-    hub->registerHandler(EventType::Chaos, [](EventPtr event) {  // NOLINT
-        auto chaos = std::static_pointer_cast<Chaos>(event);
-        std::cout << "Chaos unleashed in: " << chaos->get_target_land() << "\n";
+    hub->registerHandler(EventType::Chaos, [](const Event& event) {
+        const auto& chaos = static_cast<const Chaos&>(event);
+        std::cout << "Chaos unleashed in: " << chaos.get_target_land() << "\n";
     });
 
-    hub->registerHandler(EventType::Flood, [](EventPtr event) {  // NOLINT
-        auto flood = std::static_pointer_cast<Flood>(event);
-        std::cout << "Flood affecting: " << flood->get_target_land() << "\n";
+    hub->registerHandler(EventType::Flood, [](const Event& event) {
+        const auto& flood = static_cast<const Flood&>(event);
+        std::cout << "Flood affecting: " << flood.get_target_land() << "\n";
     });
 
     auto anahita = std::make_unique<Anahita>(hub);
@@ -1,13 +1,32 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <memory>
+#include <numeric>
 #include <random>
+#include <set>
+#include <string>
 #include <thread>
+#include <vector>
 
+#include "eventHub/IdleStrategy.h"
+#include "eventHub/ScalingPolicy.h"
+#include "eventHub/SpecialEventQueue/InplaceFunction.h"
+#include "eventHub/SpecialEventQueue/MappedEventQueue.h"
+#include "eventHub/SpecialEventQueue/PriorityEventQueue.h"
+#include "eventHub/SpecialEventQueue/ProducerFairEventQueue.h"
+#include "eventHub/SpecialEventQueue/Queues/BoundedMpmcQueue.h"
+#include "eventHub/SpecialEventQueue/Queues/MpscQueue.h"
 #include "eventHub/SpecialEventQueue/Queues/NaiveQeue.h"
+#include "eventHub/SpecialEventQueue/Queues/SegmentedQueue.h"
+#include "eventHub/SpecialEventQueue/Queues/SpscRingQueue.h"
 #include "eventHub/SpecialEventQueue/SpecialEventQueue.h"
+#include "events/EventPool.h"
 
 using namespace eventTree::eventHubs;
 using namespace eventTree::queues;
@@ -220,4 +239,1416 @@ TEST_F(SpecialEventQueueTest, StressTest) {
 
     std::cout << "Total processed events in stress test: "
               << processedEvents.load() << std::endl;
-}
\ No newline at end of file
+}
+
+// Event types small enough for the dense, enum-indexed specialization
+enum class DenseTestEventType : std::uint8_t { TypeA, TypeB, TypeC };
+
+static_assert(DenseEnumConcept<DenseTestEventType>);
+static_assert(!DenseEnumConcept<TestEventType>);
+
+class DenseSpecialEventQueueTest : public ::testing::Test {
+   protected:
+    using TestQueue = SpecialEventQueue<DenseTestEventType,
+                                        std::function<void(const TestEvent&)>,
+                                        NaiveQueue<TestEvent>>;
+    TestQueue queue;
+};
+
+TEST_F(DenseSpecialEventQueueTest, EnqueueAndProcessSingleEvent) {
+    MockHandler<TestEvent> mockHandler;
+    EXPECT_CALL(mockHandler, Handle(::testing::_)).Times(1);
+
+    queue.appendListener(DenseTestEventType::TypeA,
+                         [&](const TestEvent& event) {
+                             mockHandler.Handle(event);
+                         });
+    queue.enqueue(DenseTestEventType::TypeA, TestEvent(42));
+    queue.processOne();
+}
+
+TEST_F(DenseSpecialEventQueueTest, HandlersOnlySeeTheirOwnType) {
+    std::atomic<int> countA(0), countB(0);
+
+    queue.appendListener(DenseTestEventType::TypeA,
+                         [&](const TestEvent&) { countA++; });
+    queue.appendListener(DenseTestEventType::TypeB,
+                         [&](const TestEvent&) { countB++; });
+
+    queue.enqueue(DenseTestEventType::TypeB, TestEvent(1));
+    queue.enqueue(DenseTestEventType::TypeB, TestEvent(2));
+    queue.enqueue(DenseTestEventType::TypeA, TestEvent(3));
+
+    for (int i = 0; i < 10; ++i) {
+        queue.processOne();
+    }
+
+    EXPECT_EQ(countA.load(), 1);
+    EXPECT_EQ(countB.load(), 2);
+}
+
+TEST_F(DenseSpecialEventQueueTest, FairnessTest) {
+    const int EVENTS_PER_TYPE = 1200;
+    std::atomic<int> countA(0), countB(0), countC(0);
+
+    queue.appendListener(DenseTestEventType::TypeA,
+                         [&](const TestEvent&) { countA++; });
+    queue.appendListener(DenseTestEventType::TypeB,
+                         [&](const TestEvent&) { countB++; });
+    queue.appendListener(DenseTestEventType::TypeC,
+                         [&](const TestEvent&) { countC++; });
+
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(DenseTestEventType::TypeA, TestEvent(i));
+    }
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(DenseTestEventType::TypeB, TestEvent(i));
+    }
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(DenseTestEventType::TypeC, TestEvent(i));
+    }
+
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.processOne();
+    }
+
+    EXPECT_NEAR(countA.load(), EVENTS_PER_TYPE / 3, EVENTS_PER_TYPE / 3 * 0.1);
+    EXPECT_NEAR(countB.load(), EVENTS_PER_TYPE / 3, EVENTS_PER_TYPE / 3 * 0.1);
+    EXPECT_NEAR(countC.load(), EVENTS_PER_TYPE / 3, EVENTS_PER_TYPE / 3 * 0.1);
+}
+
+TEST_F(DenseSpecialEventQueueTest, ConcurrentEnqueueAndProcess) {
+    const int EVENTS_PER_THREAD = 10000;
+    std::atomic<int> processedEvents(0);
+
+    queue.appendListener(DenseTestEventType::TypeA,
+                         [&](const TestEvent&) { processedEvents++; });
+    queue.appendListener(DenseTestEventType::TypeB,
+                         [&](const TestEvent&) { processedEvents++; });
+
+    auto enqueueFunc = [&](DenseTestEventType type) {
+        for (int i = 0; i < EVENTS_PER_THREAD; ++i) {
+            queue.enqueue(type, TestEvent(i));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.emplace_back(enqueueFunc, DenseTestEventType::TypeA);
+    threads.emplace_back(enqueueFunc, DenseTestEventType::TypeB);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int i = 0; i < EVENTS_PER_THREAD * 2; ++i) {
+        queue.processOne();
+    }
+
+    EXPECT_EQ(processedEvents.load(), EVENTS_PER_THREAD * 2);
+}
+
+// Ready-set tests: processOne must only land on event types with work
+TEST(SpecialEventQueueReadySetTest, ProcessOneSkipsIdleEventTypes) {
+    SpecialEventQueue<int, std::function<void(const TestEvent&)>,
+                      NaiveQueue<TestEvent>>
+        queue;
+    const int EVENT_TYPES = 200;
+    std::vector<int> counts(EVENT_TYPES, 0);
+
+    for (int type = 0; type < EVENT_TYPES; ++type) {
+        queue.appendListener(
+            type, [&counts, type](const TestEvent&) { counts[type]++; });
+    }
+
+    // Two hot types, in different bitmap words, with a small backlog each
+    for (int i = 0; i < 3; ++i) {
+        queue.enqueue(5, TestEvent(i));
+        queue.enqueue(150, TestEvent(i));
+    }
+
+    // Every call does work, alternating fairly between the hot types
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(queue.processOne());
+    }
+    EXPECT_EQ(counts[5], 2);
+    EXPECT_EQ(counts[150], 2);
+
+    EXPECT_TRUE(queue.processOne());
+    EXPECT_TRUE(queue.processOne());
+    EXPECT_FALSE(queue.processOne());
+    EXPECT_EQ(counts[5], 3);
+    EXPECT_EQ(counts[150], 3);
+}
+
+// Budgeted draining
+TEST_F(SpecialEventQueueTest, ProcessBatchStopsAtMaxEvents) {
+    std::atomic<int> processedEvents(0);
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { processedEvents++; });
+    for (int i = 0; i < 10; ++i) {
+        queue.enqueue(TestEventType::TypeA, TestEvent(i));
+    }
+
+    EXPECT_EQ(queue.processBatch(4), 4u);
+    EXPECT_EQ(processedEvents.load(), 4);
+    EXPECT_EQ(queue.processBatch(100), 6u);
+    EXPECT_EQ(queue.processBatch(100), 0u);
+    EXPECT_EQ(processedEvents.load(), 10);
+}
+
+TEST_F(SpecialEventQueueTest, ProcessBatchIsFair) {
+    const int EVENTS_PER_TYPE = 300;
+    std::atomic<int> countA(0), countB(0), countC(0);
+
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { countA++; });
+    queue.appendListener(TestEventType::TypeB,
+                         [&](const TestEvent&) { countB++; });
+    queue.appendListener(TestEventType::TypeC,
+                         [&](const TestEvent&) { countC++; });
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(TestEventType::TypeA, TestEvent(i));
+    }
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(TestEventType::TypeB, TestEvent(i));
+    }
+    queue.enqueue(TestEventType::TypeC, TestEvent(0));
+
+    EXPECT_EQ(queue.processBatch(3), 3u);
+    EXPECT_EQ(countA.load(), 1);
+    EXPECT_EQ(countB.load(), 1);
+    EXPECT_EQ(countC.load(), 1);
+}
+
+TEST_F(SpecialEventQueueTest, ProcessForStopsWhenBudgetRunsOut) {
+    std::atomic<int> processedEvents(0);
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent&) {
+        processedEvents++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    });
+    for (int i = 0; i < 100; ++i) {
+        queue.enqueue(TestEventType::TypeA, TestEvent(i));
+    }
+
+    auto processed = queue.processFor(std::chrono::milliseconds(10));
+    EXPECT_GT(processed, 0u);
+    EXPECT_LT(processed, 100u);
+    EXPECT_EQ(processedEvents.load(), static_cast<int>(processed));
+
+    // Draining the rest ends as soon as the queues are empty.
+    EXPECT_EQ(queue.processFor(std::chrono::seconds(10)), 100u - processed);
+}
+
+// Blocking wakeup
+TEST_F(SpecialEventQueueTest, WaitForEventsWakesOnEnqueue) {
+    std::atomic<int> processedEvents(0);
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { processedEvents++; });
+
+    std::thread consumer([&]() {
+        while (processedEvents.load() == 0) {
+            if (!queue.processOne()) {
+                queue.waitForEvents([] { return false; });
+            }
+        }
+    });
+
+    // Give the consumer time to park before producing
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.enqueue(TestEventType::TypeA, TestEvent(1));
+    consumer.join();
+
+    EXPECT_EQ(processedEvents.load(), 1);
+}
+
+TEST_F(SpecialEventQueueTest, WaitForEventsReturnsWhenPending) {
+    queue.enqueue(TestEventType::TypeA, TestEvent(1));
+    EXPECT_TRUE(queue.hasPendingEvents());
+    queue.waitForEvents([] { return false; });  // Must not block
+
+    queue.processOne();
+    EXPECT_FALSE(queue.hasPendingEvents());
+}
+
+TEST_F(SpecialEventQueueTest, NotifyAllReleasesStoppedWaiters) {
+    std::atomic<bool> stop(false);
+    std::thread consumer([&]() {
+        while (!stop.load()) {
+            queue.waitForEvents([&] { return stop.load(); });
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    stop = true;
+    queue.notifyAll();
+    consumer.join();
+}
+
+// Consumer pools with per-consumer cursors
+TEST_F(SpecialEventQueueTest, PerConsumerCursorsKeepFairness) {
+    const int EVENTS_PER_TYPE = 1200;
+    const int CONSUMERS = 4;
+    const int EVENTS_PER_CONSUMER = EVENTS_PER_TYPE / CONSUMERS;
+    std::atomic<int> countA(0), countB(0), countC(0);
+
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { countA++; });
+    queue.appendListener(TestEventType::TypeB,
+                         [&](const TestEvent&) { countB++; });
+    queue.appendListener(TestEventType::TypeC,
+                         [&](const TestEvent&) { countC++; });
+
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(TestEventType::TypeA, TestEvent(i));
+    }
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(TestEventType::TypeB, TestEvent(i));
+    }
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(TestEventType::TypeC, TestEvent(i));
+    }
+
+    // Together the pool processes 1/3 of the events
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; ++c) {
+        consumers.emplace_back([&, c]() {
+            DispatchCursor cursor;
+            cursor.position = c;
+            EXPECT_EQ(queue.processBatch(EVENTS_PER_CONSUMER, cursor),
+                      static_cast<std::size_t>(EVENTS_PER_CONSUMER));
+        });
+    }
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+
+    EXPECT_NEAR(countA.load(), EVENTS_PER_TYPE / 3, EVENTS_PER_TYPE / 3 * 0.1);
+    EXPECT_NEAR(countB.load(), EVENTS_PER_TYPE / 3, EVENTS_PER_TYPE / 3 * 0.1);
+    EXPECT_NEAR(countC.load(), EVENTS_PER_TYPE / 3, EVENTS_PER_TYPE / 3 * 0.1);
+}
+
+TEST(SpecialEventQueueSerialTest, SerialTypesRunInOrderOneAtATime) {
+    using SerialQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          NaiveQueue<TestEvent>>;
+    SerialQueue queue(SlotOrdering::Serial);
+
+    const int EVENTS_PER_TYPE = 2000;
+    const int CONSUMERS = 4;
+    const TestEventType types[] = {TestEventType::TypeA, TestEventType::TypeB,
+                                   TestEventType::TypeC};
+
+    struct TypeState {
+        std::atomic<int> running{0};
+        std::atomic<bool> overlapped{false};
+        int next = 0;
+        bool ordered = true;
+    };
+    TypeState states[3];
+
+    for (int t = 0; t < 3; ++t) {
+        auto& state = states[t];
+        queue.appendListener(types[t], [&state](const TestEvent& e) {
+            if (state.running.fetch_add(1) != 0) {
+                state.overlapped = true;
+            }
+            // Only safe without a lock because the type runs serially.
+            state.ordered = state.ordered && e.value == state.next;
+            ++state.next;
+            std::this_thread::yield();
+            state.running.fetch_sub(1);
+        });
+    }
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        for (auto type : types) {
+            queue.enqueue(type, TestEvent(i));
+        }
+    }
+
+    std::vector<std::thread> consumers;
+    for (int c = 0; c < CONSUMERS; ++c) {
+        consumers.emplace_back([&, c]() {
+            DispatchCursor cursor;
+            cursor.position = c;
+            while (queue.processOne(cursor)) {
+            }
+        });
+    }
+    for (auto& consumer : consumers) {
+        consumer.join();
+    }
+    for (auto& state : states) {
+        EXPECT_FALSE(state.overlapped);
+        EXPECT_TRUE(state.ordered);
+        EXPECT_EQ(state.next, EVENTS_PER_TYPE);
+    }
+    EXPECT_EQ(queue.pendingEvents(), 0u);
+}
+
+TEST(SpecialEventQueueDeficitTest, WeightsSetTheShareOfEvents) {
+    using WeightedQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          NaiveQueue<TestEvent>>;
+    WeightedQueue queue(SchedulingOptions{.fairness = Fairness::Deficit});
+
+    const int EVENTS_PER_TYPE = 600;
+    int countA = 0, countB = 0, countC = 0;
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { countA++; });
+    queue.appendListener(TestEventType::TypeB,
+                         [&](const TestEvent&) { countB++; });
+    queue.appendListener(TestEventType::TypeC,
+                         [&](const TestEvent&) { countC++; });
+    queue.setWeight(TestEventType::TypeA, 3);
+    queue.setWeight(TestEventType::TypeB, 2);
+    queue.setWeight(TestEventType::TypeC, 1);
+
+    for (int i = 0; i < EVENTS_PER_TYPE; ++i) {
+        queue.enqueue(TestEventType::TypeA, TestEvent(i));
+        queue.enqueue(TestEventType::TypeB, TestEvent(i));
+        queue.enqueue(TestEventType::TypeC, TestEvent(i));
+    }
+
+    EXPECT_EQ(queue.processBatch(600), 600u);
+    EXPECT_EQ(countA, 300);
+    EXPECT_EQ(countB, 200);
+    EXPECT_EQ(countC, 100);
+}
+
+TEST(SpecialEventQueueDeficitTest, ChargingByTimeSharesHandlerTime) {
+    using WeightedQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          NaiveQueue<TestEvent>>;
+    WeightedQueue queue(SchedulingOptions{
+        .fairness = Fairness::DeficitByTime,
+        .timeQuantum = std::chrono::microseconds(20)});
+
+    auto spinFor = [](std::chrono::microseconds duration) {
+        auto end = std::chrono::steady_clock::now() + duration;
+        while (std::chrono::steady_clock::now() < end) {
+        }
+    };
+    int slow = 0, fast = 0;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent&) {
+        spinFor(std::chrono::microseconds(100));
+        slow++;
+    });
+    queue.appendListener(TestEventType::TypeB, [&](const TestEvent&) {
+        spinFor(std::chrono::microseconds(10));
+        fast++;
+    });
+
+    for (int i = 0; i < 2000; ++i) {
+        queue.enqueue(TestEventType::TypeA, TestEvent(i));
+        queue.enqueue(TestEventType::TypeB, TestEvent(i));
+    }
+    queue.processBatch(1100);
+
+    // Equal weights share time, so the fast type runs about 10x as often.
+    // Plain round robin would give both types 550 events.
+    EXPECT_EQ(slow + fast, 1100);
+    EXPECT_GT(fast, slow * 5);
+}
+
+TEST(SpecialEventQueueDeficitTest, DebtIsRepaidWithoutAPassPerQuantum) {
+    using WeightedQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          NaiveQueue<TestEvent>>;
+    WeightedQueue queue(SchedulingOptions{
+        .fairness = Fairness::DeficitByTime,
+        .timeQuantum = std::chrono::nanoseconds(1)});
+
+    int handled = 0;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent&) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        handled++;
+    });
+    queue.appendListener(TestEventType::TypeB,
+                         [&](const TestEvent&) { handled++; });
+    queue.enqueue(TestEventType::TypeA, TestEvent(1));
+    queue.enqueue(TestEventType::TypeA, TestEvent(2));
+    queue.enqueue(TestEventType::TypeB, TestEvent(3));
+    ASSERT_TRUE(queue.processOne());
+
+    // Both types are now in debt, one by 50 ms worth of 1 ns quantums. One
+    // round per pass would take tens of millions of passes to repay it.
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(queue.processOne());
+    ASSERT_TRUE(queue.processOne());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_EQ(handled, 3);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(50 + 30));
+}
+
+TEST_F(SpecialEventQueueTest, ExpiredEventsAreDroppedAndCounted) {
+    std::vector<int> handled;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        handled.push_back(e.value);
+    });
+
+    auto now = std::chrono::steady_clock::now();
+    queue.enqueue(TestEventType::TypeA, TestEvent(1),
+                  now - std::chrono::milliseconds(1));
+    queue.enqueue(TestEventType::TypeA, TestEvent(2), std::chrono::hours(1));
+    queue.enqueue(TestEventType::TypeA, TestEvent(3));
+    queue.enqueue(TestEventType::TypeB, TestEvent(4),
+                  std::chrono::milliseconds(-1));
+
+    EXPECT_EQ(queue.processBatch(10), 2u);
+    EXPECT_EQ(handled, (std::vector<int>{2, 3}));
+    EXPECT_EQ(queue.droppedEvents(TestEventType::TypeA), 1u);
+    EXPECT_EQ(queue.droppedEvents(TestEventType::TypeB), 1u);
+    // Asking about a type never used does not register it.
+    EXPECT_EQ(queue.droppedEvents(TestEventType::TypeC), 0u);
+    EXPECT_EQ(queue.droppedEvents(), 2u);
+    EXPECT_FALSE(queue.hasPendingEvents());
+}
+
+TEST(SpecialEventQueueDeadlineTest, EarliestDeadlineRunsFirst) {
+    using DeadlineQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          NaiveQueue<TestEvent>>;
+    DeadlineQueue queue(
+        SchedulingOptions{.fairness = Fairness::EarliestDeadline});
+
+    std::vector<int> handled;
+    auto record = [&](const TestEvent& e) { handled.push_back(e.value); };
+    queue.appendListener(TestEventType::TypeA, record);
+    queue.appendListener(TestEventType::TypeB, record);
+    queue.appendListener(TestEventType::TypeC, record);
+
+    auto now = std::chrono::steady_clock::now();
+    queue.enqueue(TestEventType::TypeA, TestEvent(1),
+                  now + std::chrono::seconds(30));
+    queue.enqueue(TestEventType::TypeA, TestEvent(2),
+                  now + std::chrono::seconds(40));
+    queue.enqueue(TestEventType::TypeB, TestEvent(3),
+                  now + std::chrono::seconds(10));
+    queue.enqueue(TestEventType::TypeB, TestEvent(4),
+                  now - std::chrono::seconds(1));
+    queue.enqueue(TestEventType::TypeC, TestEvent(5),
+                  now + std::chrono::seconds(20));
+
+    EXPECT_EQ(queue.processBatch(10), 4u);
+    EXPECT_EQ(handled, (std::vector<int>{3, 5, 1, 2}));
+    EXPECT_EQ(queue.droppedEvents(TestEventType::TypeB), 1u);
+
+    // Without deadlines the types still take turns, starting after the type
+    // served last.
+    handled.clear();
+    for (int i = 0; i < 2; ++i) {
+        queue.enqueue(TestEventType::TypeA, TestEvent(10 + i));
+        queue.enqueue(TestEventType::TypeB, TestEvent(20 + i));
+    }
+    EXPECT_EQ(queue.processBatch(10), 4u);
+    EXPECT_EQ(handled, (std::vector<int>{20, 10, 21, 11}));
+}
+
+TEST(SpecialEventQueueBulkTest, BulkEnqueueAndBurstsPerVisit) {
+    using BulkQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          NaiveQueue<TestEvent>>;
+    BulkQueue queue(SchedulingOptions{.burst = 4});
+
+    std::vector<int> handled;
+    auto record = [&](const TestEvent& e) { handled.push_back(e.value); };
+    queue.appendListener(TestEventType::TypeA, record);
+    queue.appendListener(TestEventType::TypeB, record);
+
+    std::vector<TestEvent> burstA, burstB;
+    for (int i = 0; i < 6; ++i) {
+        burstA.emplace_back(i);
+        burstB.emplace_back(10 + i);
+    }
+    queue.enqueueBulk(TestEventType::TypeA, burstA.begin(), burstA.end());
+    queue.enqueueBulk(TestEventType::TypeB, burstB.begin(), burstB.end());
+    EXPECT_EQ(queue.pendingEvents(), 12u);
+
+    EXPECT_EQ(queue.processBatch(100), 12u);
+    EXPECT_EQ(handled, (std::vector<int>{0, 1, 2, 3, 10, 11, 12, 13, 4, 5,
+                                         14, 15}));
+    EXPECT_FALSE(queue.hasPendingEvents());
+}
+
+// A queue that supports tokens and counts how often they are used.
+template <typename T>
+class TokenCountingQueue : public NaiveQueue<T> {
+   public:
+    struct producer_token {
+        int* pushes;
+    };
+    struct consumer_token {
+        int* pops;
+    };
+
+    static inline int tokenPushes = 0;
+    static inline int tokenPops = 0;
+
+    using NaiveQueue<T>::push;
+    using NaiveQueue<T>::pop;
+
+    producer_token producerToken() { return {&tokenPushes}; }
+    consumer_token consumerToken() { return {&tokenPops}; }
+
+    void push(producer_token& token, T&& item) {
+        ++*token.pushes;
+        NaiveQueue<T>::push(std::move(item));
+    }
+    bool pop(consumer_token& token, T& item) {
+        ++*token.pops;
+        return NaiveQueue<T>::pop(item);
+    }
+
+    static inline int tokenBulkPushes = 0;
+    static inline int tokenBulkPops = 0;
+
+    using NaiveQueue<T>::push_bulk;
+    using NaiveQueue<T>::pop_bulk;
+
+    template <typename It>
+    void push_bulk(producer_token&, It first, std::size_t count) {
+        ++tokenBulkPushes;
+        NaiveQueue<T>::push_bulk(first, count);
+    }
+    template <typename It>
+    std::size_t pop_bulk(consumer_token&, It out, std::size_t maxCount) {
+        ++tokenBulkPops;
+        return NaiveQueue<T>::pop_bulk(out, maxCount);
+    }
+};
+
+TEST(SpecialEventQueueTokenTest, TokensAreUsedByTheQueues) {
+    using TokenQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          TokenCountingQueue<TestEvent>>;
+    TokenQueue queue;
+    int handled = 0;
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { handled++; });
+    queue.appendListener(TestEventType::TypeB,
+                         [&](const TestEvent&) { handled++; });
+
+    auto producer = queue.producerToken();
+    auto consumer = queue.consumerToken();
+    for (int i = 0; i < 5; ++i) {
+        queue.enqueue(producer, TestEventType::TypeA, TestEvent(i));
+        queue.enqueue(producer, TestEventType::TypeB, TestEvent(i));
+    }
+    queue.enqueue(TestEventType::TypeA, TestEvent(5));
+
+    EXPECT_EQ(queue.processBatch(100, consumer), 11u);
+    EXPECT_EQ(handled, 11);
+    EXPECT_EQ(TokenCountingQueue<detail::Timed<TestEvent>>::tokenPushes, 10);
+    EXPECT_GE(TokenCountingQueue<detail::Timed<TestEvent>>::tokenPops, 11);
+}
+
+TEST(SpecialEventQueueTokenTest, BulkCallsUseTheTokens) {
+    using TokenQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          TokenCountingQueue<TestEvent>>;
+    using Counting = TokenCountingQueue<detail::Timed<TestEvent>>;
+    TokenQueue queue(SchedulingOptions{.burst = 4});
+    std::vector<int> handled;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        handled.push_back(e.value);
+    });
+
+    auto producer = queue.producerToken();
+    auto consumer = queue.consumerToken();
+    auto channel = queue.channel(TestEventType::TypeA);
+    std::vector<TestEvent> burst{TestEvent(1), TestEvent(2), TestEvent(3)};
+    auto pushes = Counting::tokenBulkPushes;
+    auto pops = Counting::tokenBulkPops;
+    EXPECT_EQ(queue.enqueueBulk(producer, TestEventType::TypeA, burst.begin(),
+                                burst.end()),
+              3u);
+    EXPECT_EQ(channel.pushBulk(producer, burst.begin(), burst.end()), 3u);
+    EXPECT_EQ(Counting::tokenBulkPushes - pushes, 2);
+
+    EXPECT_EQ(queue.processBatch(100, consumer), 6u);
+    EXPECT_EQ(handled, (std::vector<int>{1, 2, 3, 1, 2, 3}));
+    EXPECT_GE(Counting::tokenBulkPops - pops, 1);
+}
+
+TEST_F(SpecialEventQueueTest, ChannelsEnqueueStraightToTheirType) {
+    std::vector<int> handledA, handledB;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        handledA.push_back(e.value);
+    });
+    queue.appendListener(TestEventType::TypeB, [&](const TestEvent& e) {
+        handledB.push_back(e.value);
+    });
+
+    auto channelA = queue.channel(TestEventType::TypeA);
+    auto channelB = queue.channel(TestEventType::TypeB);
+    EXPECT_EQ(channelA.type(), TestEventType::TypeA);
+
+    // A type created after the channels leaves them valid.
+    auto channelC = queue.channel(TestEventType::TypeC);
+    channelA.push(TestEvent(1));
+    channelB.push(TestEvent(2));
+    std::vector<TestEvent> burst{TestEvent(3), TestEvent(4)};
+    EXPECT_EQ(channelA.pushBulk(burst.begin(), burst.end()), 2u);
+    channelC.push(TestEvent(5));
+
+    EXPECT_EQ(queue.processBatch(10), 5u);
+    EXPECT_EQ(handledA, (std::vector<int>{1, 3, 4}));
+    EXPECT_EQ(handledB, (std::vector<int>{2}));
+    EXPECT_FALSE(queue.hasPendingEvents());
+}
+
+TEST(SpscRingQueueTest, WrapsAroundAndRefusesWhenFull) {
+    SpscRingQueue<int, 4> ring;
+    int item = 0;
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_TRUE(ring.try_push(round * 10 + i));
+        }
+        EXPECT_FALSE(ring.try_push(99));
+        for (int i = 0; i < 4; ++i) {
+            ASSERT_TRUE(ring.pop(item));
+            EXPECT_EQ(item, round * 10 + i);
+        }
+        EXPECT_FALSE(ring.pop(item));
+    }
+}
+
+TEST(SpscRingQueueTest, OneProducerOneConsumerKeepOrder) {
+    using RingQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          SpscRingQueue<TestEvent, 64>>;
+    RingQueue queue;
+
+    const int EVENT_COUNT = 10000;
+    int expected = 0;
+    bool inOrder = true;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        inOrder = inOrder && e.value == expected;
+        expected++;
+    });
+
+    // The ring is much smaller than the burst, so the producer has to wait
+    // for the consumer.
+    std::thread producer([&] {
+        for (int i = 0; i < EVENT_COUNT; ++i) {
+            queue.enqueue(TestEventType::TypeA, TestEvent(i));
+        }
+    });
+    while (expected < EVENT_COUNT) {
+        if (!queue.processOne()) {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_FALSE(queue.hasPendingEvents());
+}
+
+TEST(BoundedMpmcQueueTest, ProducersAndConsumersShareTheRing) {
+    BoundedMpmcQueue<int, 8> ring;
+    const int PRODUCERS = 3, ITEMS = 2000;
+    std::atomic<long> sum{0};
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        threads.emplace_back([&] {
+            for (int i = 1; i <= ITEMS; ++i) {
+                ring.push(i);
+            }
+        });
+    }
+    for (int c = 0; c < 2; ++c) {
+        threads.emplace_back([&] {
+            int item = 0;
+            while (popped.load() < PRODUCERS * ITEMS) {
+                if (ring.pop(item)) {
+                    sum += item;
+                    popped++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(sum.load(), PRODUCERS * (ITEMS * (ITEMS + 1L) / 2));
+    int item = 0;
+    EXPECT_FALSE(ring.pop(item));
+}
+
+TEST(BoundedMpmcQueueTest, OverflowPoliciesPerType) {
+    using BoundedQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          BoundedMpmcQueue<TestEvent, 4>>;
+    BoundedQueue queue;
+    std::vector<int> handled;
+    auto record = [&](const TestEvent& e) { handled.push_back(e.value); };
+    queue.appendListener(TestEventType::TypeA, record);
+    queue.appendListener(TestEventType::TypeB, record);
+    queue.appendListener(TestEventType::TypeC, record);
+    queue.setOverflowPolicy(TestEventType::TypeA, OverflowPolicy::DropNewest);
+    queue.setOverflowPolicy(TestEventType::TypeB, OverflowPolicy::DropOldest);
+    queue.setOverflowPolicy(TestEventType::TypeC, OverflowPolicy::Reject);
+
+    for (int i = 0; i < 6; ++i) {
+        auto expected = i < 4 ? EnqueueStatus::Enqueued
+                              : EnqueueStatus::Dropped;
+        EXPECT_EQ(queue.enqueue(TestEventType::TypeA, TestEvent(i)), expected);
+        EXPECT_EQ(queue.enqueue(TestEventType::TypeB, TestEvent(10 + i)),
+                  EnqueueStatus::Enqueued);
+        expected = i < 4 ? EnqueueStatus::Enqueued : EnqueueStatus::Rejected;
+        EXPECT_EQ(queue.enqueue(TestEventType::TypeC, TestEvent(20 + i)),
+                  expected);
+    }
+    EXPECT_EQ(queue.pendingEvents(), 12u);
+    EXPECT_EQ(queue.droppedEvents(TestEventType::TypeA), 2u);
+    EXPECT_EQ(queue.droppedEvents(TestEventType::TypeB), 2u);
+    EXPECT_EQ(queue.droppedEvents(TestEventType::TypeC), 0u);
+
+    EXPECT_EQ(queue.processBatch(100), 12u);
+    EXPECT_EQ(handled, (std::vector<int>{0, 12, 20, 1, 13, 21, 2, 14, 22, 3,
+                                         15, 23}));
+}
+
+TEST(SpscRingQueueTest, DropOldestIsRefused) {
+    SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                      SpscRingQueue<TestEvent, 4>>
+        ring;
+    EXPECT_FALSE(ring.setOverflowPolicy(TestEventType::TypeA,
+                                        OverflowPolicy::DropOldest));
+    EXPECT_TRUE(
+        ring.setOverflowPolicy(TestEventType::TypeA, OverflowPolicy::Reject));
+
+    // The ring was kept at Reject, so a full ring is never popped by the
+    // producer.
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(ring.enqueue(TestEventType::TypeA, TestEvent(i)),
+                  EnqueueStatus::Enqueued);
+    }
+    EXPECT_EQ(ring.enqueue(TestEventType::TypeA, TestEvent(4)),
+              EnqueueStatus::Rejected);
+
+    // Mapped queues refuse it only for the types mapped to a ring.
+    MappedEventQueue<
+        TestEventType, std::function<void(const TestEvent&)>,
+        BoundedMpmcQueue<TestEvent, 4>,
+        QueueFor<TestEventType::TypeB, SpscRingQueue<TestEvent, 4>>>
+        mapped;
+    EXPECT_TRUE(mapped.setOverflowPolicy(TestEventType::TypeA,
+                                         OverflowPolicy::DropOldest));
+    EXPECT_FALSE(mapped.setOverflowPolicy(TestEventType::TypeB,
+                                          OverflowPolicy::DropOldest));
+}
+
+TEST(MpscQueueTest, ProducersKeepTheirOrderForOneConsumer) {
+    using LinkedQueue =
+        SpecialEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                          MpscQueue<TestEvent>>;
+    LinkedQueue queue;
+
+    const int PRODUCERS = 3, ITEMS = 5000;
+    std::vector<int> next(PRODUCERS, 0);
+    bool inOrder = true;
+    int handled = 0;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        auto& expected = next[e.value % PRODUCERS];
+        inOrder = inOrder && e.value / PRODUCERS == expected;
+        expected++;
+        handled++;
+    });
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < ITEMS; ++i) {
+                queue.enqueue(TestEventType::TypeA,
+                              TestEvent(i * PRODUCERS + p));
+            }
+        });
+    }
+    while (handled < PRODUCERS * ITEMS) {
+        if (!queue.processOne()) {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_TRUE(inOrder);
+    EXPECT_FALSE(queue.hasPendingEvents());
+}
+
+TEST(MpscQueueTest, SteadyStateAllocatesNoNodes) {
+    MpscQueue<int> queue;
+    auto runBursts = [&queue](int bursts) {
+        for (int burst = 0; burst < bursts; ++burst) {
+            for (int i = 0; i < 1000; ++i) {
+                queue.push(i);
+            }
+            for (int item = 0; queue.pop(item);) {
+            }
+        }
+    };
+
+    // The first bursts allocate until the consumer's batches cover a burst.
+    runBursts(5);
+    auto warmedUp = queue.allocatedNodes();
+    EXPECT_GE(warmedUp, 1000u);
+    runBursts(20);
+    EXPECT_EQ(queue.allocatedNodes(), warmedUp);
+
+    // A second producer thread reuses batches as well once it has warmed up.
+    std::thread([&] {
+        runBursts(5);
+        warmedUp = queue.allocatedNodes();
+        runBursts(20);
+    }).join();
+    EXPECT_EQ(queue.allocatedNodes(), warmedUp);
+}
+
+TEST(SegmentedQueueTest, DrainedSegmentsArePooledOrFreed) {
+    using Queue = SegmentedQueue<int, 8>;
+    Queue queue;
+    EXPECT_EQ(queue.allocatedSegments(), 0u);
+
+    const int BURST = 10 * Queue::segmentSize;
+    for (int i = 0; i < BURST; ++i) {
+        queue.push(i);
+    }
+    // Segments are mapped along with a full pool.
+    EXPECT_GE(queue.allocatedSegments(), 10u);
+    EXPECT_LE(queue.allocatedSegments(), 10u + Queue::maxPooledSegments);
+
+    int item = 0;
+    for (int i = 0; i < BURST; ++i) {
+        ASSERT_TRUE(queue.pop(item));
+        EXPECT_EQ(item, i);
+    }
+    EXPECT_FALSE(queue.pop(item));
+    EXPECT_EQ(queue.allocatedSegments(), Queue::maxPooledSegments);
+
+    // The next burst starts from the pool.
+    for (std::size_t i = 0; i < Queue::segmentSize * 3; ++i) {
+        queue.push(static_cast<int>(i));
+    }
+    EXPECT_EQ(queue.allocatedSegments(), Queue::maxPooledSegments);
+}
+
+TEST(SegmentedQueueTest, BulkCallsHonourTheHighWaterMark) {
+    using Queue = SegmentedQueue<int, 8, 2>;
+    Queue queue;
+    std::vector<int> items(10 * Queue::segmentSize);
+    std::iota(items.begin(), items.end(), 0);
+
+    // Every segment the burst needs, and a full pool, is mapped at once.
+    queue.push_bulk(items.begin(), items.size());
+    EXPECT_EQ(queue.allocatedSegments(), 10u + Queue::maxPooledSegments);
+
+    std::vector<int> popped(items.size());
+    EXPECT_EQ(queue.pop_bulk(popped.begin(), popped.size()), items.size());
+    EXPECT_EQ(popped, items);
+    EXPECT_EQ(queue.allocatedSegments(), 2u);
+
+    // A push that fits into the pool maps nothing new.
+    queue.push_bulk(items.begin(), 2 * Queue::segmentSize);
+    EXPECT_EQ(queue.allocatedSegments(), 2u);
+
+    // The next one maps its segment and refills the pool.
+    queue.push(0);
+    EXPECT_EQ(queue.allocatedSegments(), 3u + Queue::maxPooledSegments);
+}
+
+TEST(SegmentedQueueTest, SegmentsFillWholePagesAndAreUnmappedInBatches) {
+    using Queue = SegmentedQueue<int, 8, 0>;
+    static_assert(Queue::segmentBytes % 4096 == 0);
+    static_assert(Queue::segmentSize >= 8);
+    static_assert(Queue::segmentSize * sizeof(int) + 4096 >
+                  Queue::segmentBytes);
+    Queue queue;
+    const std::size_t segments = Queue::unmapBatch + 2;
+    std::vector<int> items(segments * Queue::segmentSize);
+    queue.push_bulk(items.begin(), items.size());
+
+    // Drained segments wait until a whole batch can be unmapped.
+    std::vector<int> popped(items.size());
+    std::size_t batch = (Queue::unmapBatch - 1) * Queue::segmentSize;
+    EXPECT_EQ(queue.pop_bulk(popped.begin(), batch), batch);
+    EXPECT_EQ(queue.allocatedSegments(), segments);
+    EXPECT_EQ(queue.pop_bulk(popped.begin(), Queue::segmentSize),
+              Queue::segmentSize);
+    EXPECT_EQ(queue.allocatedSegments(), 2u);
+
+    // An empty queue keeps nothing back.
+    EXPECT_EQ(queue.pop_bulk(popped.begin(), popped.size()),
+              2 * Queue::segmentSize);
+    EXPECT_EQ(queue.allocatedSegments(), 0u);
+}
+
+TEST(MappedEventQueueTest, EachTypeUsesItsOwnBackend) {
+    using Queue =
+        MappedEventQueue<TestEventType, std::function<void(const TestEvent&)>,
+                         NaiveQueue<TestEvent>,
+                         QueueFor<TestEventType::TypeA,
+                                  BoundedMpmcQueue<TestEvent, 4>>,
+                         QueueFor<TestEventType::TypeB,
+                                  SpscRingQueue<TestEvent, 8>>>;
+    Queue queue;
+
+    // Each slot holds only its own backend, not room for the largest one.
+    using RingQueue = SpscRingQueue<TestEvent, 1024>;
+    using MappedRing = MappedQueue<NaiveQueue<TestEvent>,
+                                   QueueFor<TestEventType::TypeB, RingQueue>>;
+    static_assert(sizeof(MappedRing) < sizeof(RingQueue) / 8);
+
+    std::vector<int> handled;
+    for (auto type : {TestEventType::TypeA, TestEventType::TypeB,
+                      TestEventType::TypeC}) {
+        queue.appendListener(type, [&handled](const TestEvent& e) {
+            handled.push_back(e.value);
+        });
+        queue.setOverflowPolicy(type, OverflowPolicy::Reject);
+    }
+
+    // Only TypeA's backend is bounded to four events; TypeB's ring holds
+    // eight, and TypeC falls back to the unbounded default.
+    std::array<int, 3> queued{};
+    for (int i = 0; i < 10; ++i) {
+        for (int type = 0; type < 3; ++type) {
+            auto status = queue.enqueue(static_cast<TestEventType>(type),
+                                        TestEvent(type * 100 + i));
+            queued[type] += status == EnqueueStatus::Enqueued ? 1 : 0;
+        }
+    }
+    EXPECT_EQ(queued, (std::array<int, 3>{4, 8, 10}));
+
+    while (queue.processOne()) {
+    }
+    EXPECT_EQ(handled.size(), 22u);
+    EXPECT_EQ(std::count_if(handled.begin(), handled.end(),
+                            [](int value) { return value < 100; }),
+              4);
+}
+
+TEST(InplaceFunctionTest, MoveOnlyHandlersRunFromTheQueue) {
+    using Handler = InplaceFunction<void(const TestEvent&), 32>;
+    static_assert(!std::is_copy_constructible_v<Handler>);
+    // Callables larger than the buffer are rejected at compile time.
+    static_assert(!std::is_constructible_v<
+                  Handler, decltype([buffer = std::array<char, 64>{}](
+                                        const TestEvent&) {})>);
+
+    SpecialEventQueue<TestEventType, Handler, NaiveQueue<TestEvent>> queue;
+    auto total = std::make_shared<int>(0);
+    // More handlers than fit in the first chunk of the handler list.
+    for (int i = 0; i < 20; ++i) {
+        queue.appendListener(
+            TestEventType::TypeA,
+            [total, weight = std::make_unique<int>(i)](const TestEvent& e) {
+                *total += e.value * *weight;
+            });
+    }
+    EXPECT_EQ(total.use_count(), 21);
+
+    queue.enqueue(TestEventType::TypeA, TestEvent(2));
+    EXPECT_TRUE(queue.processOne());
+    EXPECT_EQ(*total, 2 * 190);
+
+    Handler first([total](const TestEvent& e) { *total = e.value; });
+    Handler second(std::move(first));
+    EXPECT_FALSE(first);  // NOLINT
+    second(TestEvent(7));
+    EXPECT_EQ(*total, 7);
+}
+
+TEST(EventPoolTest, EventsFreedOnAnotherThreadAreRecycled) {
+    struct PooledEvent {
+        explicit PooledEvent(int value) : value(value) {}
+        int value;
+    };
+
+    const int ROUNDS = 20, EVENTS = 1000;
+    std::set<const void*> blocks;
+    for (int round = 0; round < ROUNDS; ++round) {
+        std::vector<std::shared_ptr<PooledEvent>> events;
+        std::thread producer([&events] {
+            for (int i = 0; i < EVENTS; ++i) {
+                events.push_back(
+                    eventTree::events::makePooled<PooledEvent>(i));
+            }
+        });
+        producer.join();
+        for (int i = 0; i < EVENTS; ++i) {
+            EXPECT_EQ(events[i]->value, i);
+            blocks.insert(events[i].get());
+        }
+        // Released here, on another thread than they were made on.
+        events.clear();
+    }
+
+    // Later rounds reuse the blocks freed by the earlier ones.
+    EXPECT_LT(blocks.size(), 2u * EVENTS);
+}
+
+namespace {
+
+struct LateEvent {
+    int value = 0;
+};
+
+// Used by a thread before its pool cache, so destroyed after it.
+thread_local std::shared_ptr<LateEvent> lateHolder;
+
+}  // namespace
+
+TEST(EventPoolTest, EventsReleasedAfterTheThreadCacheAreKept) {
+    const void* released = nullptr;
+    std::thread exiting([&released] {
+        lateHolder.reset();
+        lateHolder = eventTree::events::makePooled<LateEvent>();
+        released = lateHolder.get();
+    });
+    exiting.join();
+
+    // The late release went to the shared list, where the next thread to
+    // run out of blocks finds it.
+    const void* reused = nullptr;
+    std::thread next([&reused] {
+        auto event = eventTree::events::makePooled<LateEvent>();
+        reused = event.get();
+    });
+    next.join();
+    EXPECT_EQ(reused, released);
+}
+
+TEST(ProducerFairEventQueueTest, FloodingProducerDoesNotStarveOthers) {
+    ProducerFairEventQueue<int, TestEventType,
+                           std::function<void(const TestEvent&)>,
+                           NaiveQueue<TestEvent>>
+        queue;
+
+    // Producers 1 and 2 flood TypeA, producer 3 sends a few TypeA events.
+    int fromQuiet = 0, fromLoud = 0;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        (e.value == 3 ? fromQuiet : fromLoud)++;
+    });
+    for (int i = 0; i < 1000; ++i) {
+        queue.enqueue(1, TestEventType::TypeA, TestEvent(1));
+        queue.enqueue(2, TestEventType::TypeA, TestEvent(2));
+    }
+    for (int i = 0; i < 10; ++i) {
+        queue.enqueue(3, TestEventType::TypeA, TestEvent(3));
+    }
+
+    EXPECT_EQ(queue.processBatch(30), 30u);
+    EXPECT_EQ(fromQuiet, 10);
+    EXPECT_EQ(fromLoud, 20);
+}
+
+TEST(ProducerFairEventQueueTest, TypesAreFairWithinAProducer) {
+    ProducerFairEventQueue<int, TestEventType,
+                           std::function<void(const TestEvent&)>,
+                           NaiveQueue<TestEvent>>
+        queue;
+
+    int countA = 0, countB = 0;
+    for (int i = 0; i < 100; ++i) {
+        queue.enqueue(1, TestEventType::TypeA, TestEvent(i));
+    }
+    for (int i = 0; i < 100; ++i) {
+        queue.enqueue(1, TestEventType::TypeB, TestEvent(i));
+    }
+    // Handlers registered after the lane exists still reach it.
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { countA++; });
+    queue.appendListener(TestEventType::TypeB,
+                         [&](const TestEvent&) { countB++; });
+
+    EXPECT_EQ(queue.processBatch(100), 100u);
+    EXPECT_EQ(countA, 50);
+    EXPECT_EQ(countB, 50);
+    EXPECT_EQ(queue.pendingEvents(), 100u);
+}
+
+TEST(ProducerFairEventQueueTest, ProducerTokensKeepTheirLane) {
+    ProducerFairEventQueue<int, TestEventType,
+                           std::function<void(const TestEvent&)>,
+                           NaiveQueue<TestEvent>>
+        queue;
+    auto token = queue.producerToken(1);
+
+    std::vector<int> handled;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        handled.push_back(e.value);
+    });
+    for (int i = 0; i < 3; ++i) {
+        queue.enqueue(token, TestEventType::TypeA, TestEvent(i));
+        queue.enqueue(2, TestEventType::TypeA, TestEvent(10 + i));
+    }
+
+    // Handlers registered after the token was made still apply, and the
+    // token's lane takes turns with the other producer.
+    EXPECT_EQ(queue.processBatch(100), 6u);
+    EXPECT_EQ(handled, (std::vector<int>{0, 10, 1, 11, 2, 12}));
+}
+
+TEST(ProducerFairEventQueueTest, DispatchAndDefaultEnqueueUseTheDefaultLane) {
+    ProducerFairEventQueue<int, TestEventType,
+                           std::function<void(const TestEvent&)>,
+                           NaiveQueue<TestEvent>>
+        queue;
+    std::vector<int> handled;
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        handled.push_back(e.value);
+    });
+    queue.enqueue(1, TestEventType::TypeA, TestEvent(1));
+    queue.appendListener(TestEventType::TypeA, [&](const TestEvent& e) {
+        handled.push_back(-e.value);
+    });
+
+    // The default lane sees every handler, also ones added after other
+    // lanes were created.
+    queue.dispatch(TestEventType::TypeA, TestEvent(2));
+    EXPECT_EQ(handled, (std::vector<int>{2, -2}));
+
+    queue.enqueue(TestEventType::TypeA, TestEvent(3));
+    EXPECT_EQ(queue.processBatch(100), 2u);
+    EXPECT_EQ(handled, (std::vector<int>{2, -2, 3, -3, 1, -1}));
+}
+
+TEST(ProducerFairEventQueueTest, ConsumersKeepTheirOwnTypeCursorInALane) {
+    ProducerFairEventQueue<int, TestEventType,
+                           std::function<void(const TestEvent&)>,
+                           NaiveQueue<TestEvent>>
+        queue;
+    std::string handled;
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { handled += 'A'; });
+    queue.appendListener(TestEventType::TypeB,
+                         [&](const TestEvent&) { handled += 'B'; });
+    for (int i = 0; i < 2; ++i) {
+        queue.enqueue(1, TestEventType::TypeA, TestEvent(i));
+    }
+    for (int i = 0; i < 2; ++i) {
+        queue.enqueue(1, TestEventType::TypeB, TestEvent(i));
+    }
+
+    // Taking a type in the lane does not move the other consumer past it.
+    decltype(queue)::Cursor first;
+    decltype(queue)::Cursor second;
+    EXPECT_TRUE(queue.processOne(first));
+    EXPECT_TRUE(queue.processOne(second));
+    EXPECT_TRUE(queue.processOne(first));
+    EXPECT_TRUE(queue.processOne(second));
+    EXPECT_EQ(handled, "AABB");
+}
+
+TEST(PriorityEventQueueTest, HigherLanesAreServedFirst) {
+    PriorityEventQueue<SpecialEventQueue<TestEventType,
+                                         std::function<void(const TestEvent&)>,
+                                         NaiveQueue<TestEvent>>,
+                       3>
+        queue;
+
+    std::vector<int> order;
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent& e) { order.push_back(e.value); });
+    queue.enqueue(2, TestEventType::TypeA, TestEvent(2));
+    queue.enqueue(1, TestEventType::TypeA, TestEvent(1));
+    queue.enqueue(2, TestEventType::TypeA, TestEvent(2));
+    queue.enqueue(0, TestEventType::TypeA, TestEvent(0));
+
+    EXPECT_EQ(queue.processBatch(10), 4u);
+    EXPECT_EQ(order, (std::vector<int>{0, 1, 2, 2}));
+}
+
+TEST(PriorityEventQueueTest, LanesKeepTheirOwnRoundRobin) {
+    PriorityEventQueue<SpecialEventQueue<TestEventType,
+                                         std::function<void(const TestEvent&)>,
+                                         NaiveQueue<TestEvent>>,
+                       2>
+        queue;
+
+    std::vector<int> normalOrder;
+    for (auto type : {TestEventType::TypeA, TestEventType::TypeB}) {
+        queue.appendListener(type, [&, type](const TestEvent& e) {
+            if (e.value != 0) {
+                normalOrder.push_back(static_cast<int>(type));
+            }
+        });
+    }
+    for (int i = 0; i < 4; ++i) {
+        queue.enqueue(1, TestEventType::TypeA, TestEvent(1));
+        queue.enqueue(1, TestEventType::TypeB, TestEvent(1));
+    }
+
+    // High-priority events in between must not move the normal lane's turn.
+    decltype(queue)::Cursor cursor;
+    for (int i = 0; i < 8; ++i) {
+        queue.enqueue(0, i % 2 == 0 ? TestEventType::TypeA
+                                    : TestEventType::TypeB,
+                      TestEvent(0));
+        EXPECT_EQ(queue.processBatch(2, cursor), 2u);
+    }
+    EXPECT_EQ(normalOrder, (std::vector<int>{0, 1, 0, 1, 0, 1, 0, 1}));
+}
+
+TEST(PriorityEventQueueTest, AgingBoundsStarvationOfLowLanes) {
+    PriorityEventQueue<SpecialEventQueue<TestEventType,
+                                         std::function<void(const TestEvent&)>,
+                                         NaiveQueue<TestEvent>>,
+                       2>
+        queue(4);
+
+    int high = 0, low = 0;
+    queue.appendListener(TestEventType::TypeA,
+                         [&](const TestEvent&) { high++; });
+    queue.appendListener(TestEventType::TypeB,
+                         [&](const TestEvent&) { low++; });
+    for (int i = 0; i < 100; ++i) {
+        queue.enqueue(0, TestEventType::TypeA, TestEvent(i));
+        queue.enqueue(1, TestEventType::TypeB, TestEvent(i));
+    }
+
+    // Every 4 high-priority events, one low-priority event gets through.
+    EXPECT_EQ(queue.processBatch(50), 50u);
+    EXPECT_EQ(high, 40);
+    EXPECT_EQ(low, 10);
+}
+
+TEST(ScalingPolicyTest, PressureMustLastBeforeScalingUp) {
+    using namespace std::chrono_literals;
+    ElasticOptions options{.maxWorkers = 3,
+                           .scaleUpDepth = 100,
+                           .scaleUpAge = 1000ms,
+                           .scaleUpAfter = 5ms,
+                           .retireAfter = 50ms,
+                           .cooldown = 20ms};
+    auto start = ScalingPolicy::Clock::time_point{};
+    ScalingPolicy policy(options, 1, start);
+
+    // A deep queue, but not for long enough, and not after the cooldown.
+    EXPECT_EQ(policy.sample(start + 21ms, 500, 0, 1), ScalingDecision::Keep);
+    EXPECT_EQ(policy.sample(start + 24ms, 500, 100, 1), ScalingDecision::Keep);
+    // A short dip resets the pressure.
+    EXPECT_EQ(policy.sample(start + 25ms, 10, 600, 1), ScalingDecision::Keep);
+    EXPECT_EQ(policy.sample(start + 26ms, 500, 600, 1), ScalingDecision::Keep);
+    EXPECT_EQ(policy.sample(start + 31ms, 500, 700, 1),
+              ScalingDecision::ScaleUp);
+    EXPECT_EQ(policy.lastDepth(), 500u);
+
+    // The next decision waits for the cooldown, however high the pressure.
+    EXPECT_EQ(policy.sample(start + 45ms, 500, 800, 2), ScalingDecision::Keep);
+    EXPECT_EQ(policy.sample(start + 51ms, 500, 900, 2),
+              ScalingDecision::ScaleUp);
+    // The pool is at its upper bound.
+    EXPECT_EQ(policy.sample(start + 80ms, 500, 1000, 3), ScalingDecision::Keep);
+}
+
+TEST(ScalingPolicyTest, OldBacklogCountsAsPressure) {
+    using namespace std::chrono_literals;
+    ElasticOptions options{.maxWorkers = 2,
+                           .scaleUpDepth = 1000,
+                           .scaleUpAge = 50ms,
+                           .scaleUpAfter = 0ms,
+                           .cooldown = 0ms};
+    auto start = ScalingPolicy::Clock::time_point{};
+    ScalingPolicy policy(options, 1, start);
+
+    // 100 events drained at 1000 per second have waited about 100 ms.
+    EXPECT_EQ(policy.sample(start + 10ms, 100, 10, 1),
+              ScalingDecision::ScaleUp);
+    EXPECT_EQ(policy.lastBacklogAge(), 100ms);
+
+    // Nothing drained at all: the backlog is treated as infinitely old.
+    ScalingPolicy stalled(options, 1, start);
+    EXPECT_EQ(stalled.sample(start + 10ms, 1, 0, 1), ScalingDecision::ScaleUp);
+}
+
+TEST(ScalingPolicyTest, EmptyQueueRetiresDownToTheMinimum) {
+    using namespace std::chrono_literals;
+    ElasticOptions options{.maxWorkers = 4,
+                           .retireAfter = 50ms,
+                           .cooldown = 20ms};
+    auto start = ScalingPolicy::Clock::time_point{};
+    ScalingPolicy policy(options, 2, start);
+
+    EXPECT_EQ(policy.sample(start + 10ms, 0, 0, 4), ScalingDecision::Keep);
+    // Any event restarts the wait.
+    EXPECT_EQ(policy.sample(start + 40ms, 3, 0, 4), ScalingDecision::Keep);
+    EXPECT_EQ(policy.sample(start + 50ms, 0, 3, 4), ScalingDecision::Keep);
+    EXPECT_EQ(policy.sample(start + 99ms, 0, 3, 4), ScalingDecision::Keep);
+    EXPECT_EQ(policy.sample(start + 100ms, 0, 3, 4),
+              ScalingDecision::ScaleDown);
+    // Each further worker needs another full retireAfter.
+    EXPECT_EQ(policy.sample(start + 140ms, 0, 3, 3), ScalingDecision::Keep);
+    EXPECT_EQ(policy.sample(start + 150ms, 0, 3, 3),
+              ScalingDecision::ScaleDown);
+    EXPECT_EQ(policy.sample(start + 300ms, 0, 3, 2), ScalingDecision::Keep);
+}
+
+TEST(IdleStrategyTest, SpinningPollsAreCountedButNotTimed) {
+    IdleStrategy busy(IdleOptions{.kind = IdleStrategyKind::BusySpin});
+    IdleStrategy spinning(IdleOptions{.kind = IdleStrategyKind::SpinThenYield,
+                                      .spins = 1000});
+    auto park = [] { FAIL() << "only Park may park"; };
+    for (int i = 0; i < 100; ++i) {
+        busy.idle(park);
+        spinning.idle(park);
+    }
+
+    EXPECT_EQ(busy.stats().emptyPolls, 100U);
+    EXPECT_EQ(busy.stats().idleTime, std::chrono::nanoseconds::zero());
+    EXPECT_EQ(spinning.stats().emptyPolls, 100U);
+    EXPECT_EQ(spinning.stats().idleTime, std::chrono::nanoseconds::zero());
+}
+
+TEST(IdleStrategyTest, ParkingIsTimed) {
+    using namespace std::chrono_literals;
+    IdleStrategy strategy(IdleOptions{.kind = IdleStrategyKind::Park});
+    int parked = 0;
+    for (int i = 0; i < 3; ++i) {
+        strategy.idle([&] {
+            ++parked;
+            std::this_thread::sleep_for(1ms);
+        });
+    }
+
+    EXPECT_EQ(parked, 3);
+    EXPECT_EQ(strategy.stats().emptyPolls, 3U);
+    EXPECT_GE(strategy.stats().idleTime, 3ms);
+}
+
+TEST(IdleStrategyTest, BackoffDoublesUpToTheMaximumAndResets) {
+    using namespace std::chrono_literals;
+    IdleStrategy strategy(IdleOptions{.kind = IdleStrategyKind::Backoff,
+                                      .spins = 2,
+                                      .yields = 2,
+                                      .minBackoff = 1us,
+                                      .maxBackoff = 8us});
+    auto park = [] {};
+
+    // Spins and yields leave the backoff alone.
+    for (int i = 0; i < 4; ++i) {
+        strategy.idle(park);
+        EXPECT_EQ(strategy.currentBackoff(), 1us);
+    }
+    EXPECT_EQ(strategy.stats().emptyPolls, 4U);
+
+    for (auto expected : {2us, 4us, 8us, 8us}) {
+        strategy.idle(park);
+        EXPECT_EQ(strategy.currentBackoff(), expected);
+    }
+    EXPECT_EQ(strategy.stats().emptyPolls, 8U);
+    EXPECT_GE(strategy.stats().idleTime, 1us + 2us + 4us + 8us);
+
+    strategy.reset();
+    EXPECT_EQ(strategy.currentBackoff(), 1us);
+    strategy.idle(park);
+    EXPECT_EQ(strategy.currentBackoff(), 1us);
+}
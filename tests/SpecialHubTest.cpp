@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eventHub/SpecialHub.h"
+#include "events/Chaos.h"
+#include "events/Event.h"
+#include "events/Joy.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+using namespace eventTree::eventHubs;
+using eventTree::events::Chaos;
+using eventTree::events::Event;
+using eventTree::events::EventPtr;
+using eventTree::events::EventType;
+using eventTree::events::Joy;
+
+namespace {
+
+// Waits until the condition holds, giving up after a few seconds.
+bool eventually(const std::function<bool()>& condition) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST(SpecialHubPinningTest, PinnedTypesRunOnTheirOwnCpuAndThread) {
+    SpecialHub hub({}, {PinnedWorker{{EventType::Joy}, ThreadPlacement{0}}});
+
+    std::mutex mutex;
+    std::set<std::thread::id> joyThreads, blessingThreads;
+    std::atomic<int> handled{0};
+    std::atomic<int> offCpu{0};
+    hub.registerHandler(EventType::Joy, [&](const EventPtr&) {
+#if defined(__linux__)
+        offCpu += sched_getcpu() != 0;
+#endif
+        std::lock_guard<std::mutex> lock(mutex);
+        joyThreads.insert(std::this_thread::get_id());
+        ++handled;
+    });
+    hub.registerHandler(EventType::Blessing, [&](const EventPtr&) {
+        std::lock_guard<std::mutex> lock(mutex);
+        blessingThreads.insert(std::this_thread::get_id());
+        ++handled;
+    });
+
+    for (int i = 0; i < 100; ++i) {
+        hub.emitEvent(EventType::Joy, std::make_shared<Event>(EventType::Joy));
+        hub.emitEvent(EventType::Blessing,
+                      std::make_shared<Event>(EventType::Blessing));
+    }
+    ASSERT_TRUE(eventually([&] { return handled == 200; }));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(joyThreads.size(), 1U);
+    EXPECT_EQ(blessingThreads.count(*joyThreads.begin()), 0U);
+    EXPECT_EQ(offCpu, 0);
+}
+
+TEST(SpecialHubPinningTest, PinnedWorkersWithoutTypesAreRefused) {
+    EXPECT_THROW(SpecialHub({}, {PinnedWorker{}}), std::invalid_argument);
+    EXPECT_THROW(SpecialHub({}, {PinnedWorker{{EventType::Joy}, {}},
+                                 PinnedWorker{{EventType::Joy}, {}}}),
+                 std::invalid_argument);
+}
+
+namespace {
+
+// An event with the key of its strand and its place in its producer's order.
+struct KeyedEvent : Event {
+    KeyedEvent(std::size_t key, int producer, int sequence)
+        : Event(EventType::Chaos),
+          key(key),
+          producer(producer),
+          sequence(sequence) {}
+
+    std::size_t key;
+    int producer;
+    int sequence;
+};
+
+}  // namespace
+
+TEST(SpecialHubStrandTest, EventsOfAStrandRunInOrderOneAtATime) {
+    constexpr std::size_t keyCount = 4;
+    constexpr int producerCount = 2;
+    constexpr int eventsPerKey = 500;
+    StrandOptions strands{
+        [](EventType, const EventPtr& event) {
+            return static_cast<const KeyedEvent&>(*event).key;
+        },
+        keyCount};
+    DispatchOptions options;
+    options.workers = 3;
+    SpecialHub hub(options, {}, strands);
+
+    std::array<std::atomic<int>, keyCount> running{};
+    std::array<std::array<int, producerCount>, keyCount> last{};
+    std::atomic<int> overlaps{0};
+    std::atomic<int> reordered{0};
+    std::atomic<int> handled{0};
+    hub.registerHandler(EventType::Chaos, [&](const EventPtr& event) {
+        const auto& keyed = static_cast<const KeyedEvent&>(*event);
+        overlaps += running[keyed.key].fetch_add(1) != 0;
+        // Only the strand's current event touches its slot of `last`.
+        auto& previous = last[keyed.key][keyed.producer];
+        reordered += keyed.sequence != previous + 1;
+        previous = keyed.sequence;
+        std::this_thread::yield();
+        running[keyed.key].fetch_sub(1);
+        ++handled;
+    });
+
+    std::vector<std::thread> producers;
+    for (int producer = 0; producer < producerCount; ++producer) {
+        producers.emplace_back([&hub, producer] {
+            for (int sequence = 1; sequence <= eventsPerKey; ++sequence) {
+                for (std::size_t key = 0; key < keyCount; ++key) {
+                    hub.emitEvent(EventType::Chaos,
+                                  std::make_shared<KeyedEvent>(key, producer,
+                                                               sequence));
+                }
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+
+    ASSERT_TRUE(eventually([&] {
+        return handled == static_cast<int>(keyCount) * producerCount *
+                              eventsPerKey;
+    }));
+    EXPECT_EQ(overlaps, 0);
+    EXPECT_EQ(reordered, 0);
+}
+
+TEST(SpecialHubHandlerTest, EventHandlersReceiveTheEmittedEvent) {
+    SpecialHub hub;
+    std::mutex mutex;
+    std::vector<const Event*> seen;
+    std::vector<std::string> lands;
+    hub.registerHandler(EventType::Joy, [&](const Event& event) {
+        std::lock_guard<std::mutex> lock(mutex);
+        seen.push_back(&event);
+        lands.push_back(dynamic_cast<const Joy&>(event).get_target_land());
+    });
+
+    auto first = std::make_shared<Joy>("Eden");
+    auto second = std::make_shared<Joy>("Arcadia");
+    hub.emitEvent(EventType::Joy, first);
+    hub.emitEvent(EventType::Joy, second);
+    ASSERT_TRUE(eventually([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return seen.size() == 2;
+    }));
+
+    // The handler sees the emitted objects, not copies of them.
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(seen, (std::vector<const Event*>{first.get(), second.get()}));
+    EXPECT_EQ(lands, (std::vector<std::string>{"Eden", "Arcadia"}));
+}
+
+TEST(SpecialHubValueChannelTest, EventsArriveByValueAndInOrder) {
+    SpecialHub hub;
+    std::mutex mutex;
+    std::vector<std::string> lands;
+    std::atomic<int> pointerHandled{0};
+    hub.registerHandler(EventType::Joy,
+                        [&](const EventPtr&) { ++pointerHandled; });
+    hub.channel<Joy>().registerHandler([&](const Joy& joy) {
+        std::lock_guard<std::mutex> lock(mutex);
+        lands.push_back(joy.get_target_land());
+    });
+
+    // Every call opens the same queue.
+    auto channel = hub.channel<Joy>();
+    for (int i = 0; i < 50; ++i) {
+        channel.emit(Joy("land " + std::to_string(i)));
+    }
+    ASSERT_TRUE(eventually([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        return lands.size() == 50;
+    }));
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (int i = 0; i < 50; ++i) {
+        EXPECT_EQ(lands[i], "land " + std::to_string(i));
+    }
+    EXPECT_EQ(pointerHandled, 0);
+}
+
+TEST(SpecialHubValueChannelTest, ChannelThreadsFollowTheirOptions) {
+    SpecialHub hub;
+    auto channel = hub.channel<Chaos>(
+        ChannelOptions{2, {ThreadPlacement{0}, ThreadPlacement{0}}});
+
+    // Each handler waits for the other, which only two threads can do.
+    std::atomic<int> inside{0};
+    std::atomic<int> together{0};
+    std::atomic<int> offCpu{0};
+    channel.registerHandler([&](const Chaos&) {
+#if defined(__linux__)
+        offCpu += sched_getcpu() != 0;
+#endif
+        ++inside;
+        together += eventually([&] { return inside >= 2; });
+    });
+    channel.emit(Chaos());
+    channel.emit(Chaos());
+
+    ASSERT_TRUE(eventually([&] { return together == 2; }));
+    EXPECT_EQ(offCpu, 0);
+}
+
+TEST(SpecialHubShutdownTest, HandlersMayUseTheHubWhileItIsDestroyed) {
+    auto hub = std::make_unique<SpecialHub>();
+    auto* raw = hub.get();
+    std::atomic<bool> entered{false};
+    std::atomic<bool> release{false};
+    std::atomic<bool> finished{false};
+    hub->registerHandler(EventType::Joy, [&](const EventPtr&) {
+        entered = true;
+        eventually([&] { return release.load(); });
+        // Neither call may wait for the destructor, which waits for us.
+        (void)raw->idleStats();
+        (void)raw->scalingStats();
+        raw->channel<Chaos>();
+        finished = true;
+    });
+    hub->emitEvent(EventType::Joy, std::make_shared<Event>(EventType::Joy));
+    ASSERT_TRUE(eventually([&] { return entered.load(); }));
+
+    std::atomic<bool> destroyed{false};
+    std::thread destroyer([&] {
+        hub.reset();
+        destroyed = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    release = true;
+    if (!eventually([&] { return destroyed.load(); })) {
+        destroyer.detach();
+        FAIL() << "the destructor deadlocked with a running handler";
+    }
+    destroyer.join();
+    EXPECT_TRUE(finished);
+}